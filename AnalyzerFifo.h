@@ -0,0 +1,60 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Output samples for the editor's scope and spectrum view. The audio thread
+// writes a 2:1 decimated copy of each block (pairs averaged, which also
+// filters a little before the rate drops) into a wait-free SPSC FIFO; the
+// editor reads it on the message thread. Nothing is written unless an editor
+// has switched the analyzer on, and the processor skips silent blocks.
+class AnalyzerFifo
+{
+public:
+    static constexpr int capacity = 8192;
+    static constexpr int decimation = 2;
+
+    // Message thread: the editor switches the copy on while it is open.
+    // Whatever is queued is dropped either way, so a reopened editor never
+    // shows audio from before it was closed. The reader's side does this, so
+    // it is safe while the audio thread writes, unlike AbstractFifo::reset().
+    void setActive(bool shouldBeActive)
+    {
+        active = shouldBeActive;
+        fifo.finishedRead(fifo.getNumReady());
+    }
+
+    // Audio thread. At most numSamples / 2 values are copied; whatever
+    // doesn't fit is dropped.
+    void push(const float *samples, int numSamples)
+    {
+        if (!active.load(std::memory_order_relaxed))
+            return;
+
+        const auto scope = fifo.write(numSamples / decimation);
+        auto copy = [samples](float *dest, int count, int offset)
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                const int source = (offset + i) * decimation;
+                dest[i] = 0.5f * (samples[source] + samples[source + 1]);
+            }
+        };
+
+        copy(buffer.data() + scope.startIndex1, scope.blockSize1, 0);
+        copy(buffer.data() + scope.startIndex2, scope.blockSize2, scope.blockSize1);
+    }
+
+    // Message thread. Returns the number of samples read.
+    int pull(float *dest, int maxSamples)
+    {
+        const auto scope = fifo.read(maxSamples);
+        std::copy_n(buffer.data() + scope.startIndex1, scope.blockSize1, dest);
+        std::copy_n(buffer.data() + scope.startIndex2, scope.blockSize2, dest + scope.blockSize1);
+        return scope.blockSize1 + scope.blockSize2;
+    }
+
+private:
+    juce::AbstractFifo fifo{capacity};
+    std::array<float, capacity> buffer{};
+    std::atomic<bool> active{false};
+};
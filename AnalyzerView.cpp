@@ -0,0 +1,99 @@
+#include "AnalyzerView.h"
+
+static constexpr float minDecibels = -90.0f;
+static constexpr float minFrequency = 20.0f;
+
+AnalyzerView::AnalyzerView()
+{
+    setOpaque(true);
+}
+
+bool AnalyzerView::update(AnalyzerFifo &fifo, double sampleRate)
+{
+    const int numRead = fifo.pull(incoming.data(), fftSize);
+    if (numRead == 0)
+        return false;
+
+    // Shift the history left and append the new samples
+    std::copy(history.begin() + numRead, history.end(), history.begin());
+    std::copy_n(incoming.begin(), numRead, history.end() - numRead);
+
+    analyzedSampleRate = sampleRate / AnalyzerFifo::decimation;
+    buildScopePath();
+    buildSpectrumPath();
+    repaint();
+    return true;
+}
+
+void AnalyzerView::buildScopePath()
+{
+    scopePath.clear();
+    if (scopeArea.isEmpty())
+        return;
+
+    const auto *samples = history.data() + fftSize - scopeSize;
+    const float xScale = scopeArea.getWidth() / (float)(scopeSize - 1);
+    const float centre = scopeArea.getCentreY();
+    const float yScale = scopeArea.getHeight() * 0.5f;
+
+    scopePath.startNewSubPath(scopeArea.getX(), centre - samples[0] * yScale);
+    for (int i = 1; i < scopeSize; ++i)
+        scopePath.lineTo(scopeArea.getX() + (float)i * xScale,
+                         centre - juce::jlimit(-1.0f, 1.0f, samples[i]) * yScale);
+}
+
+void AnalyzerView::buildSpectrumPath()
+{
+    spectrumPath.clear();
+    if (spectrumArea.isEmpty())
+        return;
+
+    std::copy(history.begin(), history.end(), fftData.begin());
+    window.multiplyWithWindowingTable(fftData.data(), (size_t)fftSize);
+    fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+    // Log frequency axis from 20 Hz to Nyquist, one point per pixel column
+    const float nyquist = (float)analyzedSampleRate * 0.5f;
+    const float logRange = std::log(nyquist / minFrequency);
+    const int width = juce::roundToInt(spectrumArea.getWidth());
+
+    for (int x = 0; x < width; ++x)
+    {
+        const float frequency = minFrequency * std::exp(logRange * (float)x / (float)width);
+        const int bin = juce::jlimit(0, fftSize / 2 - 1, juce::roundToInt(frequency / nyquist * (fftSize / 2)));
+
+        const float level = juce::Decibels::gainToDecibels(fftData[(size_t)bin] / (fftSize * 0.25f), minDecibels);
+        const float y = juce::jmap(level, minDecibels, 0.0f, spectrumArea.getBottom(), spectrumArea.getY());
+
+        if (x == 0)
+            spectrumPath.startNewSubPath(spectrumArea.getX(), y);
+        else
+            spectrumPath.lineTo(spectrumArea.getX() + (float)x, y);
+    }
+}
+
+void AnalyzerView::paint(juce::Graphics &g)
+{
+    g.fillAll(juce::Colour(0xff1e1e1e));
+
+    g.setColour(juce::Colours::grey.withAlpha(0.4f));
+    g.drawHorizontalLine(juce::roundToInt(scopeArea.getCentreY()), scopeArea.getX(), scopeArea.getRight());
+    g.drawRect(scopeArea);
+    g.drawRect(spectrumArea);
+
+    g.setColour(juce::Colours::lime);
+    g.strokePath(scopePath, juce::PathStrokeType(1.0f));
+
+    g.setColour(juce::Colours::lightblue);
+    g.strokePath(spectrumPath, juce::PathStrokeType(1.0f));
+}
+
+void AnalyzerView::resized()
+{
+    auto area = getLocalBounds().toFloat().reduced(4.0f);
+    scopeArea = area.removeFromLeft(area.getWidth() * 0.5f).reduced(4.0f, 0.0f);
+    spectrumArea = area.reduced(4.0f, 0.0f);
+
+    buildScopePath();
+    buildSpectrumPath();
+}
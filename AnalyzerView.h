@@ -0,0 +1,42 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "AnalyzerFifo.h"
+
+// Oscilloscope (left) and spectrum (right) of the synth output. update() runs
+// once per UI frame: it drains the processor's analyzer FIFO, runs the FFT on
+// the message thread and rebuilds the two cached paths; paint() only strokes
+// them.
+class AnalyzerView : public juce::Component
+{
+public:
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int scopeSize = 512;
+
+    AnalyzerView();
+
+    // Returns true (and repaints) if new samples arrived
+    bool update(AnalyzerFifo &fifo, double sampleRate);
+
+    void paint(juce::Graphics &g) override;
+    void resized() override;
+
+private:
+    void buildScopePath();
+    void buildSpectrumPath();
+
+    juce::dsp::FFT fft{fftOrder};
+    juce::dsp::WindowingFunction<float> window{(size_t)fftSize, juce::dsp::WindowingFunction<float>::hann};
+
+    // Most recent samples, oldest first
+    std::array<float, fftSize> history{};
+    std::array<float, fftSize> incoming{};
+    std::array<float, fftSize * 2> fftData{};
+    double analyzedSampleRate = 22050.0;
+
+    juce::Rectangle<float> scopeArea, spectrumArea;
+    juce::Path scopePath, spectrumPath;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalyzerView)
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Which held key sets the base note when the arpeggiator is off
+enum class NotePriority
+{
+    last,
+    low,
+    high
+};
+
+enum class ArpMode
+{
+    off,
+    up,
+    down,
+    upDown,
+    random,
+    asPlayed
+};
+
+// Fixed-capacity set of held keys, kept both sorted by pitch and in the order
+// they were pressed. Never allocates; every operation is O(capacity).
+class HeldNotes
+{
+public:
+    static constexpr int capacity = 16;
+
+    void add(int note)
+    {
+        // Pressing a key again moves it to the end of the played order
+        remove(note);
+
+        // When full, the oldest key makes room
+        if (count == capacity)
+            remove(played[0]);
+
+        int i = count;
+        while (i > 0 && sorted[(size_t)(i - 1)] > note)
+        {
+            sorted[(size_t)i] = sorted[(size_t)(i - 1)];
+            --i;
+        }
+        sorted[(size_t)i] = (uint8_t)note;
+        played[(size_t)count] = (uint8_t)note;
+        ++count;
+    }
+
+    void remove(int note)
+    {
+        if (!erase(sorted, note))
+            return;
+
+        erase(played, note);
+        --count;
+    }
+
+    void clear() { count = 0; }
+
+    bool isEmpty() const { return count == 0; }
+    int size() const { return count; }
+
+    int getSorted(int index) const { return sorted[(size_t)index]; }
+    int getPlayed(int index) const { return played[(size_t)index]; }
+
+    int getNote(NotePriority priority) const
+    {
+        jassert(count > 0);
+        switch (priority)
+        {
+        case NotePriority::low:
+            return sorted[0];
+        case NotePriority::high:
+            return sorted[(size_t)(count - 1)];
+        case NotePriority::last:
+            break;
+        }
+        return played[(size_t)(count - 1)];
+    }
+
+    // The held note for arpeggiator step 'counter'. 'randomValue' (0..1) is
+    // only used by the random order.
+    int getArpNote(ArpMode mode, int64_t counter, float randomValue) const
+    {
+        jassert(count > 0);
+        const int n = count;
+
+        switch (mode)
+        {
+        case ArpMode::up:
+            return sorted[(size_t)(counter % n)];
+        case ArpMode::down:
+            return sorted[(size_t)(n - 1 - counter % n)];
+        case ArpMode::upDown:
+        {
+            // 0 1 2 3 2 1 0 1 ... without repeating the top and bottom notes
+            if (n == 1)
+                return sorted[0];
+            const int cycle = 2 * n - 2;
+            const int position = (int)(counter % cycle);
+            return sorted[(size_t)(position < n ? position : cycle - position)];
+        }
+        case ArpMode::random:
+            return sorted[(size_t)juce::jmin(n - 1, (int)(randomValue * n))];
+        case ArpMode::asPlayed:
+            return played[(size_t)(counter % n)];
+        case ArpMode::off:
+            break;
+        }
+        return getNote(NotePriority::last);
+    }
+
+private:
+    bool erase(std::array<uint8_t, capacity> &notes, int note)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            if (notes[(size_t)i] == note)
+            {
+                std::copy(notes.begin() + i + 1, notes.begin() + count, notes.begin() + i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::array<uint8_t, capacity> sorted{};
+    std::array<uint8_t, capacity> played{};
+    int count = 0;
+};
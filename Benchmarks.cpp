@@ -0,0 +1,337 @@
+// Standalone timing of the engine's hot paths, built with the
+// STEP_SEQUENCER_BENCHMARKS CMake option. Run the Release build; every
+// benchmark prints the best of several runs so scheduling noise drops out.
+
+#include <JuceHeader.h>
+#include "ControlRate.h"
+#include "EditorChrome.h"
+#include "StepLed.h"
+#include "StateFormat.h"
+
+static constexpr double benchSampleRate = 48000.0;
+static constexpr int benchBlockSize = 512;
+
+// Best wall-clock time of 'runs' calls to 'body', in milliseconds
+template <typename Body>
+static double measure(int runs, Body &&body)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < runs; ++run)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        body();
+        const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+        best = juce::jmin(best, juce::Time::highResolutionTicksToSeconds(elapsed) * 1000.0);
+    }
+    return best;
+}
+
+// Keeps the optimiser from discarding rendered output
+static volatile float benchSink = 0.0f;
+
+//==============================================================================
+// Glide and saw: the per-sample renderer processBlock used before control-rate
+// rendering, against closed-form glide per quantum plus renderSawSegment.
+
+struct GlideVoice
+{
+    float phase = 0.0f;
+    float currentFrequency = 220.0f;
+    float targetFrequency = 220.0f;
+    float glideRate = 1.0f / (0.1f * (float)benchSampleRate); // 100 ms glide
+};
+
+// Retargets the voice every step, so most of the run is spent gliding
+static float getBenchTarget(int64_t sample)
+{
+    static constexpr float targets[] = {220.0f, 330.0f, 262.0f, 392.0f};
+    return targets[(sample / 6000) % 4];
+}
+
+static void renderPerSample(GlideVoice &voice, float *output, int numSamples, int64_t clock)
+{
+    const float invSampleRate = 1.0f / (float)benchSampleRate;
+    for (int i = 0; i < numSamples; ++i)
+    {
+        voice.targetFrequency = getBenchTarget(clock + i);
+
+        const float diff = voice.targetFrequency - voice.currentFrequency;
+        voice.currentFrequency += diff * voice.glideRate;
+        if (std::abs(voice.targetFrequency - voice.currentFrequency) < 0.1f)
+            voice.currentFrequency = voice.targetFrequency;
+
+        output[i] = (voice.phase * 2.0f - 1.0f) * 0.3f;
+        voice.phase += voice.currentFrequency * invSampleRate;
+        if (voice.phase >= 1.0f)
+            voice.phase -= 1.0f;
+    }
+}
+
+static void renderControlRate(GlideVoice &voice, float *output, int numSamples, int64_t clock, int quantum)
+{
+    const float invSampleRate = 1.0f / (float)benchSampleRate;
+    for (int sample = 0; sample < numSamples; sample += quantum)
+    {
+        const int segment = juce::jmin(quantum, numSamples - sample);
+        voice.targetFrequency = getBenchTarget(clock + sample);
+
+        const float startFrequency = voice.currentFrequency;
+        const float decay = std::pow(1.0f - voice.glideRate, (float)segment);
+        voice.currentFrequency = voice.targetFrequency + (voice.currentFrequency - voice.targetFrequency) * decay;
+        if (std::abs(voice.targetFrequency - voice.currentFrequency) < 0.1f)
+            voice.currentFrequency = voice.targetFrequency;
+
+        voice.phase = renderSawSegment(output + sample, segment, voice.phase,
+                                       startFrequency * invSampleRate,
+                                       voice.currentFrequency * invSampleRate, 0.3f);
+    }
+}
+
+static void benchControlRate()
+{
+    // Ten seconds of audio per run
+    const int numBlocks = (int)(10.0 * benchSampleRate) / benchBlockSize;
+    std::vector<float> block((size_t)benchBlockSize);
+
+    auto run = [&](auto &&render)
+    {
+        return measure(5, [&]
+                       {
+            GlideVoice voice;
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                render(voice, block.data(), (int64_t)b * benchBlockSize);
+                benchSink = benchSink + block[0];
+            } });
+    };
+
+    std::cout << "Glide + saw, 10 s at 48 kHz" << std::endl;
+    const double perSample = run([](GlideVoice &voice, float *output, int64_t clock)
+                                 { renderPerSample(voice, output, benchBlockSize, clock); });
+    std::cout << "  per sample        " << juce::String(perSample, 2) << " ms" << std::endl;
+
+    for (int quantum : controlQuantumSizes)
+    {
+        const double controlRate = run([quantum](GlideVoice &voice, float *output, int64_t clock)
+                                       { renderControlRate(voice, output, benchBlockSize, clock, quantum); });
+        std::cout << "  quantum " << juce::String(quantum).paddedLeft(' ', 3) << "       "
+                  << juce::String(controlRate, 2) << " ms  (" << juce::String(perSample / controlRate, 1) << "x)" << std::endl;
+    }
+}
+
+//==============================================================================
+// Editor paint at 2x display scale: the full repaint per frame the editor
+// used to do (chrome plus every LED), against the cached chrome, where a frame
+// only repaints the LEDs that changed: the cached image blit clipped to each
+// LED, then the LED itself.
+
+static constexpr int editorWidth = 1280;
+static constexpr int editorHeight = 820;
+static constexpr float displayScale = 2.0f;
+static constexpr int numLeds = 8;
+
+static void benchEditorPaint()
+{
+    const int numFrames = 600; // ten seconds at 60 Hz
+    juce::Image screen(juce::Image::RGB, juce::roundToInt(editorWidth * displayScale),
+                       juce::roundToInt(editorHeight * displayScale), true);
+
+    std::array<StepLed, numLeds> leds;
+    const int stepWidth = (editorWidth - 40) / numLeds;
+    for (int i = 0; i < numLeds; ++i)
+        leds[(size_t)i].setBounds(20 + i * stepWidth + (stepWidth - 40) / 2, 190, 40, 20);
+
+    auto setPlayhead = [&](int frame)
+    {
+        for (int i = 0; i < numLeds; ++i)
+            leds[(size_t)i].setState(i == frame % numLeds ? StepLed::State::gate : StepLed::State::idle);
+    };
+
+    auto paintLed = [](juce::Graphics &g, StepLed &led)
+    {
+        juce::Graphics::ScopedSaveState state(g);
+        g.setOrigin(led.getPosition());
+        led.paint(g);
+    };
+
+    const double fullRepaint = measure(5, [&]
+                                       {
+        juce::Graphics g(screen);
+        g.addTransform(juce::AffineTransform::scale(displayScale));
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            setPlayhead(frame);
+            paintEditorChrome(g, editorWidth, true);
+            for (auto &led : leds)
+                paintLed(g, led);
+        } });
+
+    // The chrome is rendered once, as the editor does on its first paint
+    juce::Image chrome(juce::Image::RGB, screen.getWidth(), screen.getHeight(), false);
+    {
+        juce::Graphics g(chrome);
+        g.addTransform(juce::AffineTransform::scale(displayScale));
+        paintEditorChrome(g, editorWidth, true);
+    }
+
+    const double cached = measure(5, [&]
+                                  {
+        juce::Graphics g(screen);
+        g.addTransform(juce::AffineTransform::scale(displayScale));
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            setPlayhead(frame);
+
+            // The LED that went out and the one that lit up
+            for (int i : {(frame + numLeds - 1) % numLeds, frame % numLeds})
+            {
+                auto &led = leds[(size_t)i];
+                juce::Graphics::ScopedSaveState state(g);
+                g.reduceClipRegion(led.getBounds());
+                g.drawImage(chrome, juce::Rectangle<float>((float)editorWidth, (float)editorHeight));
+                paintLed(g, led);
+            }
+        } });
+
+    std::cout << "Editor paint, " << numFrames << " frames at 2x" << std::endl;
+    std::cout << "  full repaint      " << juce::String(fullRepaint, 2) << " ms" << std::endl;
+    std::cout << "  cached chrome     " << juce::String(cached, 2) << " ms  ("
+              << juce::String(fullRepaint / cached, 1) << "x)" << std::endl;
+}
+
+//==============================================================================
+// Plugin state save and load: the XML state earlier versions wrote (every lane
+// of every pattern as text, through AudioProcessor::copyXmlToBinary) against
+// StateFormat's binary sections.
+
+// The session: a parameter tree like the APVTS one and a bank where the first
+// 'numEdited' patterns have every lane changed
+static std::unique_ptr<PluginState> makeBenchState(int numEdited)
+{
+    auto state = std::make_unique<PluginState>();
+    state->parameters = juce::ValueTree("Parameters");
+    for (int i = 0; i < 20; ++i)
+    {
+        juce::ValueTree param("PARAM");
+        param.setProperty("id", "param" + juce::String(i), nullptr);
+        param.setProperty("value", 0.25 * i, nullptr);
+        state->parameters.appendChild(param, nullptr);
+    }
+
+    juce::Random random(1);
+    for (int index = 0; index < numEdited; ++index)
+        for (int lane = 0; lane < numStepLanes; ++lane)
+            for (int i = 0; i < maxPatternSteps; ++i)
+            {
+                const auto &info = stepLanes[lane];
+                state->patterns[(size_t)index].setValue((StepLane)lane, i, info.minValue + random.nextFloat() * (info.maxValue - info.minValue));
+            }
+
+    return state;
+}
+
+// The former getStateInformation, minus the groove and tuning
+static void writeXmlState(const PluginState &state, juce::MemoryBlock &destData)
+{
+    auto tree = state.parameters.createCopy();
+    juce::ValueTree bankTree("Bank");
+    bankTree.setProperty("selected", state.selectedPattern, nullptr);
+    for (int index = 0; index < numBankPatterns; ++index)
+    {
+        juce::ValueTree patternTree("Pattern");
+        for (int lane = 0; lane < numStepLanes; ++lane)
+        {
+            juce::StringArray values;
+            for (int i = 0; i < maxPatternSteps; ++i)
+                values.add(juce::String(state.patterns[(size_t)index].getValue((StepLane)lane, i), 2));
+
+            patternTree.setProperty(stepLanes[lane].id, values.joinIntoString(" "), nullptr);
+        }
+        patternTree.setProperty("index", index, nullptr);
+        bankTree.appendChild(patternTree, nullptr);
+    }
+    tree.appendChild(bankTree, nullptr);
+
+    // What AudioProcessor::copyXmlToBinary writes
+    juce::MemoryOutputStream out(destData, false);
+    out.writeInt(0x21324356);
+    out.writeInt(0);
+    tree.createXml()->writeTo(out, juce::XmlElement::TextFormat().singleLine());
+    out.writeByte(0);
+}
+
+// The former setStateInformation's XML path
+static void readXmlState(const juce::MemoryBlock &data, PluginState &state)
+{
+    const auto text = juce::String::fromUTF8(static_cast<const char *>(data.getData()) + 8, (int)data.getSize() - 9);
+    auto tree = juce::ValueTree::fromXml(*juce::parseXML(text));
+
+    auto bankTree = tree.getChildWithName("Bank");
+    state.selectedPattern = (int)bankTree["selected"];
+    for (const auto &patternTree : bankTree)
+    {
+        auto &pattern = state.patterns[(size_t)(int)patternTree["index"]];
+        for (int lane = 0; lane < numStepLanes; ++lane)
+        {
+            auto values = juce::StringArray::fromTokens(patternTree[stepLanes[lane].id].toString(), " ", {});
+            for (int i = 0; i < juce::jmin(values.size(), maxPatternSteps); ++i)
+                pattern.setValue((StepLane)lane, i, values[i].getFloatValue());
+        }
+    }
+
+    tree.removeChild(bankTree, nullptr);
+    state.parameters = tree;
+}
+
+static void benchStateFormat()
+{
+    const int runs = 20;
+    std::cout << "State save / load, " << numBankPatterns << " pattern bank" << std::endl;
+
+    for (int numEdited : {8, numBankPatterns})
+    {
+        const auto state = makeBenchState(numEdited);
+        auto loaded = std::make_unique<PluginState>();
+        juce::MemoryBlock xml, binary;
+
+        const double xmlSave = measure(5, [&]
+                                       {
+            for (int run = 0; run < runs; ++run)
+            {
+                xml.reset();
+                writeXmlState(*state, xml);
+            } }) / runs;
+        const double xmlLoad = measure(5, [&]
+                                       {
+            for (int run = 0; run < runs; ++run)
+                readXmlState(xml, *loaded); }) / runs;
+        const double binarySave = measure(5, [&]
+                                          {
+            for (int run = 0; run < runs; ++run)
+            {
+                binary.reset();
+                StateFormat::write(*state, binary);
+            } }) / runs;
+        const double binaryLoad = measure(5, [&]
+                                          {
+            for (int run = 0; run < runs; ++run)
+                StateFormat::read(binary.getData(), (int)binary.getSize(), *loaded); }) / runs;
+
+        std::cout << "  " << numEdited << " patterns edited" << std::endl;
+        std::cout << "    XML      save " << juce::String(xmlSave, 2) << " ms  load " << juce::String(xmlLoad, 2)
+                  << " ms  " << juce::roundToInt((double)xml.getSize() / 1024.0) << " kB" << std::endl;
+        std::cout << "    binary   save " << juce::String(binarySave, 2) << " ms  load " << juce::String(binaryLoad, 2)
+                  << " ms  " << juce::roundToInt((double)binary.getSize() / 1024.0) << " kB" << std::endl;
+    }
+}
+
+//==============================================================================
+int main()
+{
+    juce::ScopedJuceInitialiser_GUI gui;
+
+    benchControlRate();
+    benchEditorPaint();
+    benchStateFormat();
+    return 0;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Longest stretch of samples scheduled onto the timeline at once. Keeps the
+// number of in-flight events bounded however large the host block is.
+static constexpr int maxTimelineChunk = 256;
+
+// A sequencer event at an absolute sample position
+struct TimelineEvent
+{
+    enum class Type : uint8_t
+    {
+        step,    // the playhead reaches a step (drives the UI)
+        noteOn,  // gate opens, possibly one of several ratchets within a step
+        noteOff  // gate closes, if it still belongs to the same note
+    };
+
+    int64_t time = 0;
+    Type type = Type::step;
+    int step = 0;
+    uint32_t noteId = 0; // pairs a note-off with its note-on
+    float frequency = 0.0f;
+    float velocity = 1.0f;
+    bool glide = false;
+    int midiNote = 0; // note number for MIDI output
+    int ccValue = 0;  // step events: controller value for MIDI output
+};
+
+// Fixed-capacity, time-ordered list of upcoming sequencer events. Steps are
+// turned into events when they are scheduled (ratchets and micro-timing
+// included), so the render loop only compares against the next event time
+// no matter how dense the retriggers are.
+class BlockTimeline
+{
+public:
+    static constexpr int capacity = 256;
+
+    // Events with equal times come out in the order they were added.
+    // Returns false (and drops the event) if the timeline is full.
+    bool add(const TimelineEvent &event)
+    {
+        if (count == capacity)
+        {
+            jassertfalse;
+            return false;
+        }
+
+        // Stored latest-first, so the next event is always at the back
+        int index = 0;
+        while (index < count && events[(size_t)index].time > event.time)
+            ++index;
+
+        for (int i = count; i > index; --i)
+            events[(size_t)i] = events[(size_t)(i - 1)];
+
+        events[(size_t)index] = event;
+        ++count;
+        return true;
+    }
+
+    bool isEmpty() const { return count == 0; }
+
+    int64_t getNextEventTime() const
+    {
+        return count > 0 ? events[(size_t)(count - 1)].time : std::numeric_limits<int64_t>::max();
+    }
+
+    TimelineEvent pop()
+    {
+        jassert(count > 0);
+        return events[(size_t)--count];
+    }
+
+    void clear() { count = 0; }
+
+private:
+    std::array<TimelineEvent, capacity> events;
+    int count = 0;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Two-rate helpers: control signals (glide, modulation) are evaluated once per
+// control quantum and linearly interpolated across it at audio rate.
+
+// Selectable control quanta in samples (index matches the "control_rate" choice parameter)
+static constexpr int controlQuantumSizes[] = {8, 16, 32, 64, 128};
+static constexpr int defaultControlQuantumIndex = 2;
+static constexpr int maxControlQuantum = 128;
+
+// Number of whole samples until a fractional sample counter reaches zero (at least 1)
+inline int samplesUntil(double samplesRemaining)
+{
+    return juce::jmax(1, (int)std::ceil(samplesRemaining));
+}
+
+// Renders a saw across one segment whose phase increment ramps linearly from
+// incStart to incEnd. A gain of zero (or below) renders silence. The phase is evaluated in closed form per sample rather
+// than accumulated, so the loop has no carried dependency and vectorises.
+// Returns the phase after the segment.
+inline float renderSawSegment(float *dest, int numSamples, float phase,
+                              float incStart, float incEnd, float gain)
+{
+    const float incStep = (incEnd - incStart) / (float)numSamples;
+
+    if (gain > 0.0f)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float fi = (float)i;
+            float p = phase + fi * incStart + incStep * fi * (fi + 1.0f) * 0.5f;
+            p -= (float)(int)p;
+            dest[i] = (p * 2.0f - 1.0f) * gain;
+        }
+    }
+    else
+    {
+        juce::FloatVectorOperations::clear(dest, numSamples);
+    }
+
+    const float n = (float)numSamples;
+    float endPhase = phase + n * incStart + incStep * n * (n + 1.0f) * 0.5f;
+    return endPhase - (float)(int)endPhase;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// The editor's static panels and section titles, which it renders once into
+// its background cache. Kept apart from the editor so the paint benchmark
+// draws exactly the same chrome.
+inline void paintEditorChrome(juce::Graphics &g, int width, bool withOutputSection)
+{
+    g.fillAll(juce::Colours::darkgrey);
+
+    // Draw sequencer section background
+    g.setColour(juce::Colours::black.withAlpha(0.3f));
+    g.fillRect(10, 40, width - 20, 180);
+
+    // Draw config section background
+    g.setColour(juce::Colours::black.withAlpha(0.3f));
+    g.fillRect(10, 240, width - 20, 150);
+
+    // Draw section titles
+    g.setColour(juce::Colours::white);
+    g.setFont(16.0f);
+    g.drawText("SEQUENCER", 20, 20, 200, 20, juce::Justification::left);
+    g.drawText("CONTROLS", 20, 220, 200, 20, juce::Justification::left);
+    g.drawText("GRID", 20, 400, 200, 20, juce::Justification::left);
+
+    // Draw grid section background
+    g.setColour(juce::Colours::black.withAlpha(0.3f));
+    g.fillRect(10, 420, width - 20, 190);
+
+    if (withOutputSection)
+    {
+        g.setColour(juce::Colours::white);
+        g.drawText("OUTPUT", 20, 620, 200, 20, juce::Justification::left);
+
+        g.setColour(juce::Colours::black.withAlpha(0.3f));
+        g.fillRect(10, 640, width - 20, 170);
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "StepPattern.h"
+
+// Euclidean rhythms E(k, n): k hits spread as evenly as possible over n
+// steps, for every 1 <= n <= maxPatternSteps and 0 <= k <= n. All of them are
+// computed once, on first use, so generating a rhythm is a table lookup.
+struct EuclideanRhythm
+{
+    static constexpr int numWords = (maxPatternSteps + 63) / 64;
+    uint64_t bits[numWords];
+
+    constexpr bool isHit(int step) const { return ((bits[step / 64] >> (step % 64)) & 1) != 0; }
+};
+
+// Index of E(k, n) in the table: rows for n = 1, 2, ... hold n + 1 entries each
+constexpr int getEuclideanIndex(int hits, int steps)
+{
+    return (steps - 1) * (steps + 2) / 2 + hits;
+}
+
+static constexpr int numEuclideanRhythms = getEuclideanIndex(maxPatternSteps, maxPatternSteps) + 1;
+
+// Bresenham form: step i is a hit when (i * k) mod n < k. It gives the same
+// spacing as Bjorklund's algorithm, rotated so that step 0 is always a hit.
+constexpr EuclideanRhythm makeEuclideanRhythm(int hits, int steps)
+{
+    EuclideanRhythm rhythm{};
+    for (int i = 0; i < steps; ++i)
+        if ((i * hits) % steps < hits)
+            rhythm.bits[i / 64] |= uint64_t(1) << (i % 64);
+    return rhythm;
+}
+
+static_assert(makeEuclideanRhythm(3, 8).bits[0] == 0b01001001, "E(3, 8) is the tresillo");
+
+// The whole table is too much work for compile-time evaluation limits, so
+// it is filled at run time, the first time a rhythm is asked for
+inline const EuclideanRhythm &getEuclideanRhythm(int hits, int steps)
+{
+    static const std::vector<EuclideanRhythm> table = []
+    {
+        std::vector<EuclideanRhythm> rhythms((size_t)numEuclideanRhythms);
+        for (int n = 1; n <= maxPatternSteps; ++n)
+            for (int k = 0; k <= n; ++k)
+                rhythms[(size_t)getEuclideanIndex(k, n)] = makeEuclideanRhythm(k, n);
+        return rhythms;
+    }();
+
+    steps = juce::jlimit(1, maxPatternSteps, steps);
+    hits = juce::jlimit(0, steps, hits);
+    return table[(size_t)getEuclideanIndex(hits, steps)];
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Small, fast PCG32 generator (O'Neill's pcg32 with a fixed stream) for
+// decisions made on the audio thread. Unlike juce::Random its whole state is
+// one integer owned by the engine, so reseeding it at a known position makes
+// generative playback repeat exactly, offline renders included.
+class FastRandom
+{
+public:
+    explicit FastRandom(uint64_t seed = 0) { setSeed(seed); }
+
+    void setSeed(uint64_t seed)
+    {
+        state = 0;
+        nextInt();
+        state += seed;
+        nextInt();
+    }
+
+    uint32_t nextInt()
+    {
+        const uint64_t old = state;
+        state = old * 6364136223846793005ULL + increment;
+
+        const auto xorShifted = (uint32_t)(((old >> 18u) ^ old) >> 27u);
+        const auto rotation = (uint32_t)(old >> 59u);
+        return (xorShifted >> rotation) | (xorShifted << ((32u - rotation) & 31u));
+    }
+
+    // Uniform in [0, 1)
+    float nextFloat() { return (float)(nextInt() >> 8) * (1.0f / 16777216.0f); }
+
+private:
+    static constexpr uint64_t increment = 1442695040888963407ULL;
+    uint64_t state = 0;
+};
@@ -0,0 +1,107 @@
+#include "Groove.h"
+
+GrooveTemplate GrooveTemplate::fromMidiFile(const juce::MidiFile &file)
+{
+    GrooveTemplate groove;
+
+    // Only tempo-relative (ticks per quarter note) files carry a usable grid
+    const int ticksPerQuarter = file.getTimeFormat();
+    if (ticksPerQuarter <= 0)
+        return groove;
+
+    const double ticksPerStep = ticksPerQuarter / 4.0;
+    std::array<double, grooveTemplateLength> timingSum{};
+    std::array<double, grooveTemplateLength> velocitySum{};
+    std::array<int, grooveTemplateLength> hits{};
+
+    for (int track = 0; track < file.getNumTracks(); ++track)
+    {
+        for (const auto *event : *file.getTrack(track))
+        {
+            const auto &msg = event->message;
+            if (!msg.isNoteOn())
+                continue;
+
+            const auto gridIndex = (int64_t)std::llround(msg.getTimeStamp() / ticksPerStep);
+            const auto slot = (size_t)(gridIndex % grooveTemplateLength);
+
+            timingSum[slot] += msg.getTimeStamp() / ticksPerStep - (double)gridIndex;
+            velocitySum[slot] += msg.getFloatVelocity();
+            ++hits[slot];
+        }
+    }
+
+    float loudest = 0.0f;
+    for (size_t slot = 0; slot < grooveTemplateLength; ++slot)
+    {
+        if (hits[slot] == 0)
+        {
+            groove.velocity[slot] = 1.0f;
+            continue;
+        }
+
+        groove.timing[slot] = juce::jlimit(-maxGrooveOffset, maxGrooveOffset, (float)(timingSum[slot] / hits[slot]));
+        groove.velocity[slot] = (float)(velocitySum[slot] / hits[slot]);
+        loudest = juce::jmax(loudest, groove.velocity[slot]);
+    }
+
+    // Velocities are never negative, so this means no notes (or only silent ones)
+    if (loudest <= 0.0f)
+        return {};
+
+    // Velocities become scales relative to the loudest slot
+    for (size_t slot = 0; slot < grooveTemplateLength; ++slot)
+        if (hits[slot] > 0)
+            groove.velocity[slot] /= loudest;
+
+    groove.length = grooveTemplateLength;
+    return groove;
+}
+
+GrooveTable::GrooveTable()
+{
+    offsetFraction.fill(0.0f);
+    velocityScale.fill(1.0f);
+    offsetSamples.fill(0.0);
+}
+
+void GrooveTable::compile(const GrooveTemplate &groove, float swing)
+{
+    // Swing works on step pairs, so the table always covers an even number of steps
+    length = groove.length == 0 ? 2 : (groove.length % 2 == 0 ? groove.length : groove.length * 2);
+
+    const float swingOffset = 2.0f * swing - 1.0f;
+
+    for (int i = 0; i < length; ++i)
+    {
+        float offset = (i % 2 == 1) ? swingOffset : 0.0f;
+        float velocity = 1.0f;
+
+        if (groove.length > 0)
+        {
+            offset += groove.timing[i % groove.length];
+            velocity = groove.velocity[i % groove.length];
+        }
+
+        offsetFraction[(size_t)i] = juce::jlimit(-maxGrooveOffset, maxGrooveOffset, offset);
+        velocityScale[(size_t)i] = velocity;
+    }
+
+    rescale();
+}
+
+void GrooveTable::setStepLength(double stepLengthInSamples)
+{
+    // Differences this small move no offset by a measurable amount
+    if (std::abs(stepLengthInSamples - stepLength) < 1.0e-9)
+        return;
+
+    stepLength = stepLengthInSamples;
+    rescale();
+}
+
+void GrooveTable::rescale()
+{
+    for (int i = 0; i < length; ++i)
+        offsetSamples[(size_t)i] = offsetFraction[(size_t)i] * stepLength;
+}
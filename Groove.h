@@ -0,0 +1,54 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "StepPattern.h"
+
+static constexpr int maxGrooveSteps = 64;
+static constexpr int grooveTemplateLength = 16; // one bar of sixteenths
+static constexpr float maxGrooveOffset = 0.5f;  // fraction of a step, early or late
+
+// A groove template: per-step timing offsets (fractions of a step) and
+// velocity scales. Being tempo independent, it only has to be rebuilt when a
+// new groove is imported.
+struct GrooveTemplate
+{
+    int length = 0; // 0 means no template, only swing
+    float timing[maxGrooveSteps] = {};
+    float velocity[maxGrooveSteps] = {};
+
+    // Extracts a groove by comparing every note-on against a sixteenth note
+    // grid. Hits landing on the same grid slot of the bar are averaged.
+    static GrooveTemplate fromMidiFile(const juce::MidiFile &file);
+};
+
+static_assert(std::is_trivially_copyable_v<GrooveTemplate>, "Grooves are copied as plain memory");
+
+// Swing and groove compiled into a per-step table of sample offsets and
+// velocity scales, indexed by the step clock. compile() runs when the groove
+// or swing changes; a tempo/rate change only rescales the sample offsets.
+class GrooveTable
+{
+public:
+    GrooveTable();
+
+    // Swing is 0.5 (straight) to 0.75 (hard swing): the share of a step pair
+    // taken by its first step
+    void compile(const GrooveTemplate &groove, float swing);
+
+    // Cheap: one multiply per entry, and nothing at all if the length is unchanged
+    void setStepLength(double stepLengthInSamples);
+
+    double getOffset(int64_t stepClock) const { return offsetSamples[(size_t)(stepClock % length)]; }
+    float getVelocity(int64_t stepClock) const { return velocityScale[(size_t)(stepClock % length)]; }
+
+private:
+    static constexpr int capacity = maxGrooveSteps * 2;
+
+    void rescale();
+
+    int length = 1;
+    double stepLength = 0.0;
+    std::array<float, capacity> offsetFraction;
+    std::array<float, capacity> velocityScale;
+    std::array<double, capacity> offsetSamples;
+};
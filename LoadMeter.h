@@ -0,0 +1,94 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// DSP load of one plugin instance: the wall-clock time of each processBlock
+// as a fraction of the block's real-time budget (numSamples / sampleRate).
+// The audio thread only reads the high-resolution clock and bumps a counter
+// in a histogram of relaxed atomics; the editor reads the counters and works
+// out peak and percentiles from the difference to an earlier snapshot.
+class LoadMeter
+{
+public:
+    static constexpr int binsPerUnit = 100; // 1% of the budget per bin
+    static constexpr int numBins = 2 * binsPerUnit + 1; // up to 200%, the last bin collects overruns
+
+    using Histogram = std::array<uint32_t, numBins>;
+
+    // Times one processBlock from construction to destruction
+    class ScopedBlock
+    {
+    public:
+        ScopedBlock(LoadMeter &meterToUse, int numSamplesInBlock)
+            : meter(meterToUse), numSamples(numSamplesInBlock), start(juce::Time::getHighResolutionTicks())
+        {
+        }
+
+        ~ScopedBlock() { meter.addBlock(juce::Time::getHighResolutionTicks() - start, numSamples); }
+
+    private:
+        LoadMeter &meter;
+        const int numSamples;
+        const int64_t start;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedBlock)
+    };
+
+    // Before playback starts
+    void prepare(double sampleRate)
+    {
+        ticksPerSample = sampleRate > 0.0 ? (double)juce::Time::getHighResolutionTicksPerSecond() / sampleRate : 0.0;
+    }
+
+    // Audio thread
+    void addBlock(int64_t elapsedTicks, int numSamples)
+    {
+        if (numSamples <= 0 || ticksPerSample <= 0.0)
+            return;
+
+        const float load = (float)((double)elapsedTicks / ((double)numSamples * ticksPerSample));
+        current.store(load, std::memory_order_relaxed);
+
+        const int bin = juce::jlimit(0, numBins - 1, (int)(load * binsPerUnit));
+        counts[(size_t)bin].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Any thread. Load of the most recent block (1 = the whole budget).
+    float getCurrent() const { return current.load(std::memory_order_relaxed); }
+
+    // Any thread. Counts since the instance was created.
+    Histogram getHistogram() const
+    {
+        Histogram histogram;
+        for (size_t i = 0; i < histogram.size(); ++i)
+            histogram[i] = counts[i].load(std::memory_order_relaxed);
+        return histogram;
+    }
+
+    // Load below which 'fraction' of the blocks between two snapshots fell,
+    // rounded up to the bin edge. 0 if no blocks were measured.
+    static float getPercentile(const Histogram &now, const Histogram &before, float fraction)
+    {
+        uint32_t total = 0;
+        for (size_t i = 0; i < now.size(); ++i)
+            total += now[i] - before[i];
+
+        if (total == 0)
+            return 0.0f;
+
+        const auto target = (uint32_t)std::ceil((double)total * fraction);
+        uint32_t sum = 0;
+        for (size_t i = 0; i < now.size(); ++i)
+        {
+            sum += now[i] - before[i];
+            if (sum >= target)
+                return (float)(i + 1) / binsPerUnit;
+        }
+        return (float)numBins / binsPerUnit;
+    }
+
+private:
+    double ticksPerSample = 0.0;
+    std::atomic<float> current{0.0f};
+    std::array<std::atomic<uint32_t>, numBins> counts{};
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "StepPattern.h"
+#include "SnapshotPublisher.h"
+
+static constexpr int numBankPatterns = 64;
+
+// Where a queued pattern change may take effect
+enum class SwitchQuantize
+{
+    step,
+    beat,
+    bar
+};
+
+// Whether a step is the first of a beat and of a bar. Beats and bars follow
+// the host's time signature and bar position while it plays; otherwise steps
+// count as sixteenths from the sequencer restart.
+struct StepPosition
+{
+    bool beatStart = true;
+    bool barStart = true;
+};
+
+inline bool isSwitchBoundary(SwitchQuantize quantize, StepPosition position)
+{
+    switch (quantize)
+    {
+    case SwitchQuantize::step:
+        return true;
+    case SwitchQuantize::beat:
+        return position.beatStart;
+    case SwitchQuantize::bar:
+        return position.barStart;
+    }
+    return true;
+}
+
+// All patterns of the bank, preloaded. Each slot publishes its own snapshots,
+// so switching patterns on the audio thread is an index change and edits to
+// any slot (playing or not) never block it.
+using PatternPublisher = SnapshotPublisher<Pattern>;
+using PatternBank = std::array<PatternPublisher, numBankPatterns>;
+
+// Wait-free single-producer/single-consumer queue carrying pattern change
+// requests from the message thread to the audio thread
+class PatternChangeQueue
+{
+public:
+    // Message thread. Returns false if the queue is full.
+    bool push(int pattern)
+    {
+        const auto scope = fifo.write(1);
+        if (scope.blockSize1 == 0)
+            return false;
+
+        requests[(size_t)scope.startIndex1] = pattern;
+        return true;
+    }
+
+    // Audio thread. Returns false if nothing is queued.
+    bool pop(int &pattern)
+    {
+        const auto scope = fifo.read(1);
+        if (scope.blockSize1 == 0)
+            return false;
+
+        pattern = requests[(size_t)scope.startIndex1];
+        return true;
+    }
+
+private:
+    static constexpr int capacity = 32;
+    juce::AbstractFifo fifo{capacity};
+    std::array<int, capacity> requests{};
+};
@@ -0,0 +1,172 @@
+#include "PatternLibrary.h"
+
+static const uint32_t libraryMagic = juce::ByteOrder::littleEndianInt("S8PL");
+static constexpr uint32_t libraryVersion = 1;
+
+bool PatternLibrary::open(const juce::File &file)
+{
+    close();
+
+    auto mapped = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly, false);
+    const auto size = (uint64_t)mapped->getSize();
+    if (mapped->getData() == nullptr || size < sizeof(Header))
+        return false;
+
+    Header fileHeader;
+    std::memcpy(&fileHeader, mapped->getData(), sizeof(Header));
+
+    // Records are copied as plain memory, so the layout must match this build
+    if (fileHeader.magic != libraryMagic || fileHeader.version != libraryVersion
+        || fileHeader.recordSize != sizeof(Pattern) || fileHeader.numSteps != (uint32_t)maxPatternSteps
+        || fileHeader.numLanes != (uint32_t)numStepLanes)
+        return false;
+
+    // Offsets are checked on their own first so the sums below can't wrap
+    const uint64_t count = fileHeader.numPatterns;
+    if (fileHeader.indexOffset > size || fileHeader.namesOffset > size || fileHeader.namesSize > size
+        || fileHeader.recordsOffset > size || count > size)
+        return false;
+
+    if (fileHeader.indexOffset + count * sizeof(Entry) > size
+        || fileHeader.namesOffset + fileHeader.namesSize > size
+        || fileHeader.recordsOffset + count * sizeof(Pattern) > size)
+        return false;
+
+    mappedFile = std::move(mapped);
+    libraryFile = file;
+    header = fileHeader;
+    numPatterns = (int)count;
+    return true;
+}
+
+void PatternLibrary::close()
+{
+    mappedFile.reset();
+    libraryFile = juce::File();
+    header = {};
+    numPatterns = 0;
+}
+
+const char *PatternLibrary::getBytes(uint64_t offset, uint64_t size) const
+{
+    // Written so that neither comparison can wrap
+    const auto mappedSize = (uint64_t)mappedFile->getSize();
+    if (offset > mappedSize || size > mappedSize - offset)
+        return nullptr;
+
+    return static_cast<const char *>(mappedFile->getData()) + offset;
+}
+
+PatternLibrary::Entry PatternLibrary::getEntry(int index) const
+{
+    jassert(juce::isPositiveAndBelow(index, numPatterns));
+    Entry entry{};
+    if (const auto *bytes = getBytes(header.indexOffset + (uint64_t)index * sizeof(Entry), sizeof(Entry)))
+        std::memcpy(&entry, bytes, sizeof(Entry));
+    return entry;
+}
+
+juce::String PatternLibrary::getName(int index) const
+{
+    if (!juce::isPositiveAndBelow(index, numPatterns))
+        return {};
+
+    const auto entry = getEntry(index);
+    if ((uint64_t)entry.nameOffset + entry.nameLength > header.namesSize)
+        return {};
+
+    const auto *name = getBytes(header.namesOffset + entry.nameOffset, entry.nameLength);
+    if (name == nullptr)
+        return {};
+
+    return juce::String::fromUTF8(name, (int)entry.nameLength);
+}
+
+int PatternLibrary::getLength(int index) const
+{
+    if (!juce::isPositiveAndBelow(index, numPatterns))
+        return defaultPatternLength;
+
+    return juce::jlimit(1, maxPatternSteps, (int)getEntry(index).length);
+}
+
+juce::Array<int> PatternLibrary::find(const juce::String &text) const
+{
+    juce::Array<int> matches;
+    for (int i = 0; i < numPatterns; ++i)
+        if (text.isEmpty() || getName(i).containsIgnoreCase(text))
+            matches.add(i);
+    return matches;
+}
+
+bool PatternLibrary::readPattern(int index, Pattern &pattern) const
+{
+    if (!juce::isPositiveAndBelow(index, numPatterns))
+        return false;
+
+    const auto *record = getBytes(header.recordsOffset + (uint64_t)index * sizeof(Pattern), sizeof(Pattern));
+    if (record == nullptr)
+        return false;
+
+    std::memcpy(&pattern, record, sizeof(Pattern));
+
+    // The file may come from anywhere; keep every value in range, and replace
+    // NaN (which clamping lets through) and infinity with the lane's default
+    for (int lane = 0; lane < numStepLanes; ++lane)
+        for (int i = 0; i < maxPatternSteps; ++i)
+        {
+            const float value = pattern.getValue((StepLane)lane, i);
+            pattern.setValue((StepLane)lane, i, std::isfinite(value) ? value : stepLanes[lane].defaultValue);
+        }
+
+    return true;
+}
+
+bool PatternLibrary::write(const juce::File &file, const std::vector<LibraryRecord> &records)
+{
+    juce::MemoryOutputStream names;
+    std::vector<Entry> entries;
+    for (const auto &record : records)
+    {
+        const auto start = (uint32_t)names.getDataSize();
+        names << record.name;
+        entries.push_back({start, (uint32_t)names.getDataSize() - start, (uint32_t)record.length, 0});
+    }
+
+    Header fileHeader{};
+    fileHeader.magic = libraryMagic;
+    fileHeader.version = libraryVersion;
+    fileHeader.recordSize = sizeof(Pattern);
+    fileHeader.numSteps = maxPatternSteps;
+    fileHeader.numLanes = numStepLanes;
+    fileHeader.numPatterns = (uint32_t)records.size();
+    fileHeader.indexOffset = sizeof(Header);
+    fileHeader.namesOffset = fileHeader.indexOffset + entries.size() * sizeof(Entry);
+    fileHeader.namesSize = names.getDataSize();
+
+    // Records start on a 64-byte boundary, like Pattern itself
+    const uint64_t namesEnd = fileHeader.namesOffset + fileHeader.namesSize;
+    fileHeader.recordsOffset = (namesEnd + 63) & ~(uint64_t)63;
+
+    // Write next to the target and swap it in, so a mapped library is never half written
+    juce::TemporaryFile temp(file);
+    {
+        juce::FileOutputStream stream(temp.getFile());
+        if (!stream.openedOk())
+            return false;
+
+        stream.write(&fileHeader, sizeof(Header));
+        stream.write(entries.data(), entries.size() * sizeof(Entry));
+        stream.write(names.getData(), names.getDataSize());
+        stream.writeRepeatedByte(0, fileHeader.recordsOffset - namesEnd);
+
+        for (const auto &record : records)
+            stream.write(&record.pattern, sizeof(Pattern));
+
+        stream.flush();
+        if (stream.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
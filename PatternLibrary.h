@@ -0,0 +1,81 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "StepPattern.h"
+
+// A pattern as written to a library
+struct LibraryRecord
+{
+    juce::String name;
+    int length = defaultPatternLength;
+    Pattern pattern;
+};
+
+// Read-only pattern library file, memory-mapped so that only the pages
+// actually touched are read from disk. The file holds a fixed header, an
+// index of fixed-size entries, a UTF-8 string table with the names, and the
+// patterns as fixed-size records in the engine's own Pattern layout:
+//
+//     header | index entries | names | records (64-byte aligned)
+//
+// Opening only checks the header. Browsing and searching read the index and
+// the string table; loading a pattern copies one record. Libraries written
+// with a different Pattern layout are refused rather than converted.
+class PatternLibrary
+{
+public:
+    bool open(const juce::File &file);
+    void close();
+
+    bool isOpen() const { return mappedFile != nullptr; }
+    const juce::File &getFile() const { return libraryFile; }
+
+    int getNumPatterns() const { return numPatterns; }
+    juce::String getName(int index) const;
+    int getLength(int index) const;
+
+    // Indices of the patterns whose name contains 'text' (case-insensitive)
+    juce::Array<int> find(const juce::String &text) const;
+
+    // Copies a record, clamping every value into its lane's range. Values
+    // that aren't finite load as the lane's default.
+    bool readPattern(int index, Pattern &pattern) const;
+
+    static bool write(const juce::File &file, const std::vector<LibraryRecord> &records);
+
+private:
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t recordSize; // sizeof(Pattern) of the writing build
+        uint32_t numSteps;
+        uint32_t numLanes;
+        uint32_t numPatterns;
+        uint64_t indexOffset;
+        uint64_t namesOffset;
+        uint64_t namesSize;
+        uint64_t recordsOffset;
+        uint64_t reserved;
+    };
+
+    struct Entry
+    {
+        uint32_t nameOffset; // into the string table
+        uint32_t nameLength; // bytes
+        uint32_t length;     // steps that play
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(Header) == 64 && sizeof(Entry) == 16, "Library file layout");
+
+    // The mapped bytes at [offset, offset + size), or nullptr if that isn't
+    // inside the file
+    const char *getBytes(uint64_t offset, uint64_t size) const;
+    Entry getEntry(int index) const;
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    juce::File libraryFile;
+    Header header{};
+    int numPatterns = 0;
+};
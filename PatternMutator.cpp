@@ -0,0 +1,257 @@
+#include "PatternMutator.h"
+
+static int toPitchState(float pitch)
+{
+    return juce::jlimit(0, (int)(maxStepPitch - minStepPitch), juce::roundToInt(pitch - minStepPitch));
+}
+
+PatternMutator::PatternMutator(juce::AudioProcessorValueTreeState &apvts)
+    : juce::Thread("Pattern Mutator"),
+      modeParam(apvts.getRawParameterValue("mutation")),
+      rateParam(apvts.getRawParameterValue("mutation_rate")),
+      depthParam(apvts.getRawParameterValue("mutation_depth")),
+      seedParam(apvts.getRawParameterValue("seed")),
+      lengthParam(apvts.getRawParameterValue("length"))
+{
+    startTimer(50);
+}
+
+PatternMutator::~PatternMutator()
+{
+    stopTimer();
+    stop();
+}
+
+void PatternMutator::start()
+{
+    active = true;
+    updateThread();
+}
+
+void PatternMutator::stop()
+{
+    active = false;
+    updateThread();
+}
+
+void PatternMutator::updateThread()
+{
+    // The thread only exists while there is something to mutate
+    if (active && readSettings().mode != MutationMode::off)
+    {
+        if (!isThreadRunning())
+            startThread(juce::Thread::Priority::low);
+    }
+    else if (isThreadRunning())
+    {
+        stopThread(1000);
+    }
+}
+
+void PatternMutator::setSource(const Pattern &pattern, int bankIndex)
+{
+    auto snapshot = std::make_unique<Snapshot<MutationPattern>>();
+    snapshot->value.pattern = pattern;
+    snapshot->value.bankIndex = bankIndex;
+    source.publish(std::move(snapshot));
+    notify();
+}
+
+void PatternMutator::timerCallback()
+{
+    updateThread();
+    if (!isThreadRunning())
+        return;
+
+    // Wake the mutator when bars were played or an input changed
+    const auto settings = readSettings();
+    const auto playing = barPlaying.load();
+    const auto rewound = rewinds.load();
+    if (playing != notifiedBar || rewound != notifiedRewinds || settings != notifiedSettings)
+    {
+        notifiedBar = playing;
+        notifiedRewinds = rewound;
+        notifiedSettings = settings;
+        notify();
+    }
+}
+
+MutationSettings PatternMutator::readSettings() const
+{
+    MutationSettings settings;
+    settings.mode = (MutationMode)(int)modeParam->load();
+    settings.rate = rateParam->load();
+    settings.depth = depthParam->load();
+    settings.seed = (uint32_t)seedParam->load();
+    settings.length = juce::jlimit(1, maxPatternSteps, (int)lengthParam->load());
+    return settings;
+}
+
+void PatternMutator::rewind()
+{
+    bar = -1;
+    liveSlot = -1;
+    barPlaying = 0;
+    ++rewinds;
+}
+
+bool PatternMutator::acquire(bool waitIfMissing)
+{
+    barPlaying = ++bar;
+    const int previousSlot = liveSlot;
+
+    // Bar 0 plays the source itself
+    if (bar == 0 || (MutationMode)(int)modeParam->load() == MutationMode::off)
+    {
+        liveSlot = -1;
+        return previousSlot >= 0;
+    }
+
+    const int slotIndex = (int)(bar % numSlots);
+    auto &slot = slots[(size_t)slotIndex];
+    const auto rewound = rewinds.load();
+    auto takeGeneration = [&]
+    {
+        slot.acquire();
+        return slot.getLive().bar == bar && slot.getLive().rewind == rewound;
+    };
+
+    bool ready = takeGeneration();
+
+    // Offline renders can outrun the mutator; wait rather than skip the bar
+    for (int attempt = 0; !ready && waitIfMissing && isThreadRunning() && attempt < 100; ++attempt)
+    {
+        notify();
+        generationReady.wait(10);
+        ready = takeGeneration();
+    }
+
+    if (ready)
+        liveSlot = slotIndex;
+    else if (liveSlot == slotIndex)
+        liveSlot = -1; // the generation playing was just replaced
+
+    return liveSlot != previousSlot || ready;
+}
+
+const MutationPattern &PatternMutator::getLive() const
+{
+    return liveSlot < 0 ? noGeneration : slots[(size_t)liveSlot].getLive();
+}
+
+void PatternMutator::run()
+{
+    while (!threadShouldExit())
+    {
+        generate();
+        wait(-1);
+    }
+}
+
+void PatternMutator::generate()
+{
+    const auto settings = readSettings();
+    if (settings.mode == MutationMode::off)
+        return;
+
+    if (source.acquire())
+        sourceChanged = true;
+
+    // A sequencer restart starts the chain over at bar 0; an edit or a new
+    // setting starts it over at the bar playing
+    const auto rewound = rewinds.load();
+    if (rewound != current.rewind)
+        restart(settings, rewound, 0);
+    else if (sourceChanged || settings != currentSettings)
+        restart(settings, rewound, barPlaying.load());
+
+    if (base.bankIndex < 0)
+        return;
+
+    // Bars already played are still computed, so every generation depends
+    // only on the chain and never on how late the thread ran
+    while (current.bar < barPlaying.load() + barsAhead && !threadShouldExit())
+    {
+        ++current.bar;
+        random.setSeed(((uint64_t)settings.seed << 32) ^ (uint64_t)current.bar);
+        mutate();
+        slots[(size_t)(current.bar % numSlots)].publish(current);
+        generationReady.signal();
+    }
+}
+
+void PatternMutator::restart(const MutationSettings &settings, uint32_t rewound, int64_t startBar)
+{
+    currentSettings = settings;
+    sourceChanged = false;
+    base = source.getLive();
+    current = base;
+    current.bar = startBar;
+    current.rewind = rewound;
+    buildTransitions();
+}
+
+void PatternMutator::buildTransitions()
+{
+    std::memset(transitions, 0, sizeof(transitions));
+
+    const int length = currentSettings.length;
+    for (int i = 0; i < length; ++i)
+    {
+        const int from = toPitchState(base.pattern.pitch[i]);
+        const int to = toPitchState(base.pattern.pitch[(i + 1) % length]);
+        ++transitions[from][to];
+    }
+}
+
+void PatternMutator::mutate()
+{
+    const auto mode = currentSettings.mode;
+    const int length = currentSettings.length;
+    const float rate = currentSettings.rate;
+    const float depth = currentSettings.depth;
+
+    // Depth bounds how far any step may drift from the source pattern
+    const float maxPitchShift = std::round(depth * maxStepPitch);
+    auto &pattern = current.pattern;
+    const auto &original = base.pattern;
+
+    for (int i = 0; i < length; ++i)
+    {
+        if (random.nextFloat() >= rate)
+            continue;
+
+        float pitch = pattern.pitch[i];
+        float velocity = pattern.velocity[i];
+
+        if (mode == MutationMode::markov)
+        {
+            // Draw the next pitch from the transitions out of the previous step's pitch
+            const auto &row = transitions[toPitchState(pattern.pitch[(i + length - 1) % length])];
+            int total = 0;
+            for (auto count : row)
+                total += count;
+
+            if (total > 0)
+            {
+                int pick = (int)(random.nextFloat() * (float)total);
+                int state = 0;
+                while (pick >= row[state])
+                    pick -= row[state++];
+                pitch = minStepPitch + (float)state;
+            }
+        }
+        else
+        {
+            pitch += random.nextFloat() < 0.5f ? -1.0f : 1.0f;
+            velocity += (random.nextFloat() - 0.5f) * 0.2f;
+        }
+
+        pattern.pitch[i] = juce::jlimit(juce::jmax(minStepPitch, original.pitch[i] - maxPitchShift),
+                                        juce::jmin(maxStepPitch, original.pitch[i] + maxPitchShift),
+                                        pitch);
+        pattern.velocity[i] = juce::jlimit(juce::jmax(0.0f, original.velocity[i] - depth),
+                                           juce::jmin(1.0f, original.velocity[i] + depth),
+                                           velocity);
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "StepPattern.h"
+#include "SnapshotPublisher.h"
+#include "FastRandom.h"
+
+enum class MutationMode
+{
+    off,
+    markov,    // pitches follow the step-to-step transitions of the source pattern
+    randomWalk // pitches and velocities drift a little at a time
+};
+
+// A bank pattern as handed to the mutator, or a mutated generation handed back
+struct MutationPattern
+{
+    Pattern pattern;
+    int bankIndex = -1;
+    int64_t bar = -1;      // bar the generation is for, counted from the sequencer restart
+    uint32_t rewind = 0;   // sequencer restart it belongs to
+};
+
+// The inputs a generation is computed from, besides the source pattern
+struct MutationSettings
+{
+    MutationMode mode = MutationMode::off;
+    float rate = 0.0f;
+    float depth = 0.0f;
+    uint32_t seed = 0;
+    int length = 0;
+
+    bool operator==(const MutationSettings &other) const
+    {
+        return mode == other.mode && juce::exactlyEqual(rate, other.rate) && juce::exactlyEqual(depth, other.depth)
+               && seed == other.seed && length == other.length;
+    }
+
+    bool operator!=(const MutationSettings &other) const { return !(*this == other); }
+};
+
+// Evolves a copy of the selected pattern on its own thread, one generation
+// per bar played. Mutations are constrained to the "mutation_depth" range
+// around the source pattern. Each generation is computed from the previous
+// one with a random stream seeded by the "seed" parameter and its bar index,
+// and is published up to 'barsAhead' bars before it plays, keyed by that
+// bar. The audio thread takes the generation for each bar as it starts, so
+// a run with the same seed, source and settings repeats bar for bar, however
+// the mutator thread is scheduled.
+//
+// The chain restarts from the source pattern at bar 0 of every sequencer
+// restart, and at the bar playing when the source or settings change. The
+// thread only runs while mutation is on, and sleeps until a bar is played or
+// an input changes.
+class PatternMutator : private juce::Thread,
+                       private juce::Timer
+{
+public:
+    static constexpr int barsAhead = 16;
+
+    explicit PatternMutator(juce::AudioProcessorValueTreeState &apvts);
+    ~PatternMutator() override;
+
+    // Any thread: enable or disable the mutator (around prepareToPlay/releaseResources)
+    void start();
+    void stop();
+
+    // Message thread: the pattern mutations start from (after an edit or a pattern selection)
+    void setSource(const Pattern &pattern, int bankIndex);
+
+    // Audio thread, at the sequencer restart. Until the first generation is
+    // taken, getLive() holds no pattern and the source plays unchanged.
+    void rewind();
+
+    // Audio thread, at every bar boundary: takes the generation for the bar
+    // starting. In real time a generation that isn't ready is skipped; offline
+    // renders ('waitIfMissing') wait for it. Returns true if the pattern changed.
+    bool acquire(bool waitIfMissing);
+    const MutationPattern &getLive() const;
+
+private:
+    void run() override;
+    void timerCallback() override;
+    void updateThread();
+    MutationSettings readSettings() const;
+    void generate();
+    void restart(const MutationSettings &settings, uint32_t rewound, int64_t startBar);
+    void buildTransitions();
+    void mutate();
+
+    std::atomic<float> *modeParam;
+    std::atomic<float> *rateParam;
+    std::atomic<float> *depthParam;
+    std::atomic<float> *seedParam;
+    std::atomic<float> *lengthParam;
+
+    std::atomic<bool> active{false};
+
+    SnapshotPublisher<MutationPattern> source; // message thread -> mutator
+
+    // Mutator -> audio thread, one publisher per bar modulo the ring size
+    static constexpr int numSlots = barsAhead + 1;
+    std::array<SnapshotPublisher<MutationPattern>, numSlots> slots;
+    juce::WaitableEvent generationReady;
+
+    // Audio thread state, shared as atomics for the mutator
+    std::atomic<int64_t> barPlaying{0};
+    std::atomic<uint32_t> rewinds{0};
+    int64_t bar = -1;
+    int liveSlot = -1; // -1 while no generation is playing
+    MutationPattern noGeneration;
+
+    // Message thread: inputs seen by the timer, to wake the mutator on a change
+    int64_t notifiedBar = -1;
+    uint32_t notifiedRewinds = 0;
+    MutationSettings notifiedSettings;
+
+    // Mutator thread state
+    MutationPattern base;
+    MutationPattern current; // generation for 'current.bar'
+    MutationSettings currentSettings;
+    bool sourceChanged = true;
+    FastRandom random;
+
+    // Pitch transition counts of the source, in whole semitones
+    static constexpr int numPitchStates = (int)(maxStepPitch - minStepPitch) + 1;
+    uint16_t transitions[numPitchStates][numPitchStates] = {};
+
+    JUCE_DECLARE_NON_COPYABLE(PatternMutator)
+};
@@ -1,30 +1,253 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+// Hits / steps / rotation controls for the Euclidean generator. Every change
+// regenerates the pattern right away.
+class EuclideanPanel : public juce::Component
+{
+public:
+    std::function<void(int hits, int steps, int rotation)> onChange;
+
+    EuclideanPanel(int hits, int steps, int rotation)
+    {
+        setupSlider(hitsSlider, hitsLabel, "Hits", 0, steps, hits);
+        setupSlider(stepsSlider, stepsLabel, "Steps", 1, maxPatternSteps, steps);
+        setupSlider(rotationSlider, rotationLabel, "Rotation", 0, steps - 1, rotation);
+        setSize(230, 100);
+    }
+
+    void resized() override
+    {
+        auto area = getLocalBounds().reduced(8).withTrimmedLeft(70);
+        hitsSlider.setBounds(area.removeFromTop(28));
+        stepsSlider.setBounds(area.removeFromTop(28));
+        rotationSlider.setBounds(area.removeFromTop(28));
+    }
+
+private:
+    void setupSlider(juce::Slider &slider, juce::Label &label, const juce::String &name, int min, int max, int value)
+    {
+        slider.setSliderStyle(juce::Slider::IncDecButtons);
+        slider.setTextBoxStyle(juce::Slider::TextBoxLeft, false, 50, 22);
+        slider.setRange(min, max, 1);
+        slider.setValue(value, juce::dontSendNotification);
+        slider.onValueChange = [this]
+        { update(); };
+        addAndMakeVisible(slider);
+
+        label.setText(name, juce::dontSendNotification);
+        label.attachToComponent(&slider, true);
+        addAndMakeVisible(label);
+    }
+
+    void update()
+    {
+        // Hits and rotation are bounded by the step count
+        const int steps = (int)stepsSlider.getValue();
+        hitsSlider.setRange(0, steps, 1);
+        rotationSlider.setRange(0, steps - 1, 1);
+
+        if (onChange)
+            onChange((int)hitsSlider.getValue(), steps, (int)rotationSlider.getValue());
+    }
+
+    juce::Slider hitsSlider, stepsSlider, rotationSlider;
+    juce::Label hitsLabel, stepsLabel, rotationLabel;
+};
+
+// Searchable list of a pattern library's patterns. Only the rows on screen
+// read names from the mapped file. Double-click or Return loads a pattern.
+class LibraryPanel : public juce::Component,
+                     private juce::ListBoxModel
+{
+public:
+    std::function<void(int index)> onLoad;
+
+    explicit LibraryPanel(const PatternLibrary &libraryToShow) : library(libraryToShow)
+    {
+        searchBox.setTextToShowWhenEmpty("Search", juce::Colours::grey);
+        searchBox.onTextChange = [this]
+        { updateMatches(); };
+        searchBox.onReturnKey = [this]
+        { load(listBox.getSelectedRow()); };
+        addAndMakeVisible(searchBox);
+
+        listBox.setModel(this);
+        addAndMakeVisible(listBox);
+
+        updateMatches();
+        setSize(260, 320);
+    }
+
+    void resized() override
+    {
+        auto area = getLocalBounds().reduced(8);
+        searchBox.setBounds(area.removeFromTop(24));
+        area.removeFromTop(6);
+        listBox.setBounds(area);
+    }
+
+private:
+    int getNumRows() override { return matches.size(); }
+
+    void paintListBoxItem(int row, juce::Graphics &g, int width, int height, bool rowIsSelected) override
+    {
+        if (!juce::isPositiveAndBelow(row, matches.size()))
+            return;
+
+        if (rowIsSelected)
+            g.fillAll(juce::Colours::green.withAlpha(0.6f));
+
+        const int index = matches[row];
+        g.setColour(juce::Colours::white);
+        g.drawText(library.getName(index), 6, 0, width - 50, height, juce::Justification::centredLeft, true);
+        g.setColour(juce::Colours::lightgrey);
+        g.drawText(juce::String(library.getLength(index)), width - 44, 0, 38, height, juce::Justification::centredRight);
+    }
+
+    void listBoxItemDoubleClicked(int row, const juce::MouseEvent &) override { load(row); }
+    void returnKeyPressed(int row) override { load(row); }
+
+    void updateMatches()
+    {
+        matches = library.find(searchBox.getText().trim());
+        listBox.updateContent();
+        listBox.selectRow(0);
+    }
+
+    void load(int row)
+    {
+        if (juce::isPositiveAndBelow(row, matches.size()) && onLoad)
+            onLoad(matches[row]);
+    }
+
+    const PatternLibrary &library;
+    juce::Array<int> matches; // library indices shown, in order
+    juce::TextEditor searchBox;
+    juce::ListBox listBox;
+};
+
 StepSequencerAudioProcessorEditor::StepSequencerAudioProcessorEditor(StepSequencerAudioProcessor &p)
     : AudioProcessorEditor(&p), audioProcessor(p)
 {
-    setSize(800, 400);
+    setOpaque(true); // the cached background covers everything
+#if JucePlugin_IsMidiEffect
+    setSize(1280, 620);
+#else
+    setSize(1280, 820);
+#endif
 
     // Setup step sliders
-    for (int i = 0; i < NUM_STEPS; ++i)
+    for (int i = 0; i < STEPS_PER_PAGE; ++i)
     {
         auto &slider = stepSliders[i];
         slider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
         slider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 60, 20);
-        slider.setTextValueSuffix(" st");
+        slider.onValueChange = [this, i]
+        {
+            stepGrid.flush(); // staged grid edits land first, then the knob's value
+            audioProcessor.setStepValue(currentLane, currentPage * STEPS_PER_PAGE + i, (float)stepSliders[i].getValue());
+            stepGrid.reload();
+        };
         addAndMakeVisible(slider);
 
-        stepAttachments[i] = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-            audioProcessor.getValueTreeState(), "step" + juce::String(i), slider);
-
         auto &label = stepLabels[i];
-        label.setText(juce::String(i + 1), juce::dontSendNotification);
         label.setJustificationType(juce::Justification::centred);
         label.attachToComponent(&slider, false);
         addAndMakeVisible(label);
+
+        addAndMakeVisible(stepLeds[i]);
     }
 
+    // Setup page navigation
+    prevPageButton.onClick = [this]
+    { showPage(currentPage - 1); };
+    nextPageButton.onClick = [this]
+    { showPage(currentPage + 1); };
+    addAndMakeVisible(prevPageButton);
+    addAndMakeVisible(nextPageButton);
+
+    pageLabel.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(pageLabel);
+
+    // Setup pattern bank selector
+    for (int i = 0; i < numBankPatterns; ++i)
+        patternBox.addItem("Pattern " + juce::String(i + 1), i + 1);
+    patternBox.setSelectedId(audioProcessor.getSelectedPattern() + 1, juce::dontSendNotification);
+    patternBox.onChange = [this]
+    {
+        stepGrid.flush(); // grid edits belong to the pattern they were made on
+        audioProcessor.selectPattern(patternBox.getSelectedId() - 1);
+        showPage(currentPage);
+    };
+    addAndMakeVisible(patternBox);
+    addAndMakeVisible(playingLabel);
+
+    // Setup fill and seed
+    fillButton.setClickingTogglesState(true);
+    addAndMakeVisible(fillButton);
+    fillAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+        audioProcessor.getValueTreeState(), "fill", fillButton);
+
+    seedSlider.setSliderStyle(juce::Slider::IncDecButtons);
+    seedSlider.setTextBoxStyle(juce::Slider::TextBoxLeft, false, 50, 22);
+    addAndMakeVisible(seedSlider);
+    seedAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getValueTreeState(), "seed", seedSlider);
+
+    seedLabel.setText("Seed", juce::dontSendNotification);
+    seedLabel.attachToComponent(&seedSlider, true);
+    addAndMakeVisible(seedLabel);
+
+    // Setup scale quantizer
+    if (auto *scaleParam = dynamic_cast<juce::AudioParameterChoice *>(
+            audioProcessor.getValueTreeState().getParameter("scale")))
+        scaleBox.addItemList(scaleParam->choices, 1);
+    addAndMakeVisible(scaleBox);
+    scaleAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getValueTreeState(), "scale", scaleBox);
+
+    scaleLabel.setText("Scale", juce::dontSendNotification);
+    scaleLabel.attachToComponent(&scaleBox, true);
+    addAndMakeVisible(scaleLabel);
+
+    if (auto *keyParam = dynamic_cast<juce::AudioParameterChoice *>(
+            audioProcessor.getValueTreeState().getParameter("key")))
+        keyBox.addItemList(keyParam->choices, 1);
+    addAndMakeVisible(keyBox);
+    keyAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getValueTreeState(), "key", keyBox);
+
+    // Setup grid editor
+    gridViewport.setViewedComponent(&stepGrid, false);
+    gridViewport.setScrollBarsShown(true, true);
+    addAndMakeVisible(gridViewport);
+
+    // Note currently playing
+    noteLabel.setJustificationType(juce::Justification::centredRight);
+    addAndMakeVisible(noteLabel);
+
+    // Setup DSP load display
+    loadBaseline = audioProcessor.getLoadMeter().getHistogram();
+    loadLabel.setJustificationType(juce::Justification::centredRight);
+    loadLabel.setColour(juce::Label::textColourId, juce::Colours::lightgrey);
+    addAndMakeVisible(loadLabel);
+
+    // Setup lane selector
+    for (int lane = 0; lane < numStepLanes; ++lane)
+        laneBox.addItem(stepLanes[lane].name, lane + 1);
+    laneBox.setSelectedId(1, juce::dontSendNotification);
+    laneBox.onChange = [this]
+    {
+        currentLane = (StepLane)(laneBox.getSelectedId() - 1);
+        showPage(currentPage);
+    };
+    addAndMakeVisible(laneBox);
+
+    editButton.onClick = [this]
+    { showEditMenu(); };
+    addAndMakeVisible(editButton);
+
     // Setup rate slider
     rateSlider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
     rateSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
@@ -49,12 +272,34 @@ StepSequencerAudioProcessorEditor::StepSequencerAudioProcessorEditor(StepSequenc
     gateLabel.attachToComponent(&gateSlider, false);
     addAndMakeVisible(gateLabel);
 
+    // Setup swing slider and groove import
+    swingSlider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
+    swingSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
+    addAndMakeVisible(swingSlider);
+    swingAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getValueTreeState(), "swing", swingSlider);
+
+    swingLabel.setText("Swing", juce::dontSendNotification);
+    swingLabel.setJustificationType(juce::Justification::centred);
+    swingLabel.attachToComponent(&swingSlider, false);
+    addAndMakeVisible(swingLabel);
+
+    grooveButton.onClick = [this]
+    { showGrooveMenu(); };
+    addAndMakeVisible(grooveButton);
+
     // Setup glide toggle
     glideToggle.setButtonText("Glide");
     addAndMakeVisible(glideToggle);
     glideAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
         audioProcessor.getValueTreeState(), "glide_enable", glideToggle);
 
+#if !JucePlugin_IsMidiEffect
+    // Setup microtuning import
+    tuningButton.onClick = [this]
+    { showTuningMenu(); };
+    addAndMakeVisible(tuningButton);
+
     // Setup glide time slider
     glideTimeSlider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
     glideTimeSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
@@ -66,66 +311,228 @@ StepSequencerAudioProcessorEditor::StepSequencerAudioProcessorEditor(StepSequenc
     glideTimeLabel.setJustificationType(juce::Justification::centred);
     glideTimeLabel.attachToComponent(&glideTimeSlider, false);
     addAndMakeVisible(glideTimeLabel);
+#endif
+
+    // Setup pattern switch quantize selector
+    if (auto *quantizeParam = dynamic_cast<juce::AudioParameterChoice *>(
+            audioProcessor.getValueTreeState().getParameter("switch_quantize")))
+        switchQuantizeBox.addItemList(quantizeParam->choices, 1);
+    addAndMakeVisible(switchQuantizeBox);
+    switchQuantizeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getValueTreeState(), "switch_quantize", switchQuantizeBox);
+
+    switchQuantizeLabel.setText("Switch On", juce::dontSendNotification);
+    switchQuantizeLabel.setJustificationType(juce::Justification::centred);
+    switchQuantizeLabel.attachToComponent(&switchQuantizeBox, false);
+    addAndMakeVisible(switchQuantizeLabel);
+
+    // Setup pattern length slider
+    lengthSlider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
+    lengthSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
+    addAndMakeVisible(lengthSlider);
+    lengthAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getValueTreeState(), "length", lengthSlider);
+
+    lengthLabel.setText("Length", juce::dontSendNotification);
+    lengthLabel.setJustificationType(juce::Justification::centred);
+    lengthLabel.attachToComponent(&lengthSlider, false);
+    addAndMakeVisible(lengthLabel);
+
+#if !JucePlugin_IsMidiEffect
+    // Setup MIDI output controls
+    if (auto *outputModeParam = dynamic_cast<juce::AudioParameterChoice *>(
+            audioProcessor.getValueTreeState().getParameter("output_mode")))
+        outputModeBox.addItemList(outputModeParam->choices, 1);
+    addAndMakeVisible(outputModeBox);
+    outputModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getValueTreeState(), "output_mode", outputModeBox);
+
+    outputModeLabel.setText("Output", juce::dontSendNotification);
+    outputModeLabel.setJustificationType(juce::Justification::centred);
+    outputModeLabel.attachToComponent(&outputModeBox, false);
+    addAndMakeVisible(outputModeLabel);
+#endif
+
+    midiCcSlider.setSliderStyle(juce::Slider::IncDecButtons);
+    midiCcSlider.setTextBoxStyle(juce::Slider::TextBoxLeft, false, 50, 24);
+    addAndMakeVisible(midiCcSlider);
+    midiCcAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getValueTreeState(), "midi_cc", midiCcSlider);
+
+    midiCcLabel.setText("Step CC", juce::dontSendNotification);
+    midiCcLabel.setJustificationType(juce::Justification::centred);
+    midiCcLabel.attachToComponent(&midiCcSlider, false);
+    addAndMakeVisible(midiCcLabel);
 
-    // Start timer for LED updates (30 FPS)
-    startTimerHz(30);
+    // Setup arpeggiator and held note priority selectors
+    if (auto *arpModeParam = dynamic_cast<juce::AudioParameterChoice *>(
+            audioProcessor.getValueTreeState().getParameter("arp_mode")))
+        arpModeBox.addItemList(arpModeParam->choices, 1);
+    addAndMakeVisible(arpModeBox);
+    arpModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getValueTreeState(), "arp_mode", arpModeBox);
+
+    arpModeLabel.setText("Arp", juce::dontSendNotification);
+    arpModeLabel.setJustificationType(juce::Justification::centred);
+    arpModeLabel.attachToComponent(&arpModeBox, false);
+    addAndMakeVisible(arpModeLabel);
+
+    if (auto *priorityParam = dynamic_cast<juce::AudioParameterChoice *>(
+            audioProcessor.getValueTreeState().getParameter("note_priority")))
+        notePriorityBox.addItemList(priorityParam->choices, 1);
+    addAndMakeVisible(notePriorityBox);
+    notePriorityAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getValueTreeState(), "note_priority", notePriorityBox);
+
+    notePriorityLabel.setText("Priority", juce::dontSendNotification);
+    notePriorityLabel.setJustificationType(juce::Justification::centred);
+    notePriorityLabel.attachToComponent(&notePriorityBox, false);
+    addAndMakeVisible(notePriorityLabel);
+
+    // Setup mutation mode, rate and depth
+    if (auto *mutationParam = dynamic_cast<juce::AudioParameterChoice *>(
+            audioProcessor.getValueTreeState().getParameter("mutation")))
+        mutationBox.addItemList(mutationParam->choices, 1);
+    addAndMakeVisible(mutationBox);
+    mutationAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getValueTreeState(), "mutation", mutationBox);
+
+    mutationLabel.setText("Mutation", juce::dontSendNotification);
+    mutationLabel.setJustificationType(juce::Justification::centred);
+    mutationLabel.attachToComponent(&mutationBox, false);
+    addAndMakeVisible(mutationLabel);
+
+    mutationRateSlider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
+    mutationRateSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    mutationRateSlider.setPopupDisplayEnabled(true, true, this);
+    addAndMakeVisible(mutationRateSlider);
+    mutationRateAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getValueTreeState(), "mutation_rate", mutationRateSlider);
+
+    mutationRateLabel.setText("Rate", juce::dontSendNotification);
+    mutationRateLabel.setJustificationType(juce::Justification::centred);
+    mutationRateLabel.attachToComponent(&mutationRateSlider, false);
+    addAndMakeVisible(mutationRateLabel);
+
+    mutationDepthSlider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
+    mutationDepthSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    mutationDepthSlider.setPopupDisplayEnabled(true, true, this);
+    addAndMakeVisible(mutationDepthSlider);
+    mutationDepthAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getValueTreeState(), "mutation_depth", mutationDepthSlider);
+
+    mutationDepthLabel.setText("Depth", juce::dontSendNotification);
+    mutationDepthLabel.setJustificationType(juce::Justification::centred);
+    mutationDepthLabel.attachToComponent(&mutationDepthSlider, false);
+    addAndMakeVisible(mutationDepthLabel);
+
+#if !JucePlugin_IsMidiEffect
+    // Setup control rate selector
+    if (auto *controlRateParam = dynamic_cast<juce::AudioParameterChoice *>(
+            audioProcessor.getValueTreeState().getParameter("control_rate")))
+        controlRateBox.addItemList(controlRateParam->choices, 1);
+    addAndMakeVisible(controlRateBox);
+    controlRateAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getValueTreeState(), "control_rate", controlRateBox);
+
+    controlRateLabel.setText("Control Rate", juce::dontSendNotification);
+    controlRateLabel.setJustificationType(juce::Justification::centred);
+    controlRateLabel.attachToComponent(&controlRateBox, false);
+    addAndMakeVisible(controlRateLabel);
+#endif
+
+    lastPatternLength = audioProcessor.getPatternLength();
+    lastPatternVersion = audioProcessor.getPatternVersion();
+    showPage(0);
+
+#if !JucePlugin_IsMidiEffect
+    // The processor only copies samples for the analyzer while an editor is open
+    addAndMakeVisible(analyzerView);
+    audioProcessor.getAnalyzer().setActive(true);
+#endif
+
+    // LED and display updates run on the shared vblank tick
+    refreshDriver->addClient(*this, *this);
 }
 
 StepSequencerAudioProcessorEditor::~StepSequencerAudioProcessorEditor()
 {
-    stopTimer();
+    refreshDriver->removeClient(*this);
+#if !JucePlugin_IsMidiEffect
+    audioProcessor.getAnalyzer().setActive(false);
+#endif
 }
 
-void StepSequencerAudioProcessorEditor::paint(juce::Graphics &g)
+void StepSequencerAudioProcessorEditor::visibilityChanged()
 {
-    g.fillAll(juce::Colours::darkgrey);
-
-    // Draw sequencer section background
-    g.setColour(juce::Colours::black.withAlpha(0.3f));
-    g.fillRect(10, 40, getWidth() - 20, 180);
+    refreshDriver->clientVisibilityChanged();
+}
 
-    // Draw config section background
-    g.setColour(juce::Colours::black.withAlpha(0.3f));
-    g.fillRect(10, 240, getWidth() - 20, 150);
+void StepSequencerAudioProcessorEditor::parentHierarchyChanged()
+{
+    refreshDriver->clientVisibilityChanged();
+}
 
-    // Draw section titles
-    g.setColour(juce::Colours::white);
-    g.setFont(16.0f);
-    g.drawText("SEQUENCER", 20, 20, 200, 20, juce::Justification::left);
-    g.drawText("CONTROLS", 20, 220, 200, 20, juce::Justification::left);
+void StepSequencerAudioProcessorEditor::paint(juce::Graphics &g)
+{
+    TRACE_SCOPE("paint");
+    // Re-render the chrome only when the size or the display scale changed
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const int imageWidth = juce::roundToInt(getWidth() * scale);
+    const int imageHeight = juce::roundToInt(getHeight() * scale);
 
-    // Draw LED indicators for each step
-    int stepWidth = (getWidth() - 40) / NUM_STEPS;
-    for (int i = 0; i < NUM_STEPS; ++i)
+    if (!backgroundCache.isValid() || backgroundCache.getWidth() != imageWidth || backgroundCache.getHeight() != imageHeight)
     {
-        int x = 20 + i * stepWidth + (stepWidth - 40) / 2;
-        int y = 190;
-
-        // Highlight current step
-        if (i == lastDisplayedStep)
-            g.setColour(juce::Colours::lime);
-        else
-            g.setColour(juce::Colours::darkgrey);
+        backgroundCache = juce::Image(juce::Image::RGB, imageWidth, imageHeight, false);
+        juce::Graphics imageGraphics(backgroundCache);
+        imageGraphics.addTransform(juce::AffineTransform::scale(scale));
+        renderBackground(imageGraphics);
+    }
 
-        g.fillRoundedRectangle(x, y, 40, 20, 4.0f);
+    g.drawImage(backgroundCache, getLocalBounds().toFloat());
+}
 
-        // Border
-        g.setColour(juce::Colours::grey);
-        g.drawRoundedRectangle(x, y, 40, 20, 4.0f, 1.0f);
-    }
+void StepSequencerAudioProcessorEditor::renderBackground(juce::Graphics &g)
+{
+#if JucePlugin_IsMidiEffect
+    paintEditorChrome(g, getWidth(), false);
+#else
+    paintEditorChrome(g, getWidth(), true);
+#endif
 }
 
 void StepSequencerAudioProcessorEditor::resized()
 {
-    int stepWidth = (getWidth() - 40) / NUM_STEPS;
+    backgroundCache = {};
+    int stepWidth = (getWidth() - 40) / STEPS_PER_PAGE;
 
-    // Layout step sliders in sequencer section
-    for (int i = 0; i < NUM_STEPS; ++i)
+    // Layout step sliders and their LEDs in sequencer section
+    for (int i = 0; i < STEPS_PER_PAGE; ++i)
     {
         int x = 20 + i * stepWidth;
         stepSliders[i].setBounds(x, 60, stepWidth - 10, 100);
+        stepLeds[i].setBounds(x + (stepWidth - 40) / 2, 190, 40, 20);
     }
 
+    // Page navigation sits next to the section title
+    nextPageButton.setBounds(getWidth() - 50, 14, 30, 22);
+    pageLabel.setBounds(getWidth() - 170, 14, 120, 22);
+    prevPageButton.setBounds(getWidth() - 200, 14, 30, 22);
+    laneBox.setBounds(getWidth() - 330, 14, 120, 22);
+    editButton.setBounds(getWidth() - 400, 14, 60, 22);
+    patternBox.setBounds(130, 14, 110, 22);
+    playingLabel.setBounds(245, 14, 120, 22);
+    fillButton.setBounds(375, 14, 50, 22);
+    noteLabel.setBounds(getWidth() - 100, 218, 80, 22);
+    loadLabel.setBounds(getWidth() - 360, 218, 250, 22);
+    gridViewport.setBounds(15, 425, getWidth() - 30, 180);
+#if !JucePlugin_IsMidiEffect
+    analyzerView.setBounds(15, 645, getWidth() - 30, 160);
+#endif
+    seedSlider.setBounds(480, 14, 110, 22);
+    scaleBox.setBounds(650, 14, 130, 22);
+    keyBox.setBounds(785, 14, 60, 22);
+
     // Layout config section controls
     int configY = 260;
     int controlSpacing = 120;
@@ -134,16 +541,379 @@ void StepSequencerAudioProcessorEditor::resized()
     rateSlider.setBounds(startX, configY, 100, 100);
     gateSlider.setBounds(startX + controlSpacing, configY, 100, 100);
     glideToggle.setBounds(startX + controlSpacing * 2, configY + 20, 80, 30);
+    grooveButton.setBounds(startX + controlSpacing * 2, configY + 58, 80, 24);
+    tuningButton.setBounds(startX + controlSpacing * 2, configY + 88, 80, 24);
     glideTimeSlider.setBounds(startX + controlSpacing * 3, configY, 100, 100);
+    controlRateBox.setBounds(startX + controlSpacing * 4, configY + 20, 100, 24);
+    switchQuantizeBox.setBounds(startX + controlSpacing * 4, configY + 76, 100, 24);
+    lengthSlider.setBounds(startX + controlSpacing * 5, configY, 100, 100);
+    swingSlider.setBounds(startX + controlSpacing * 6, configY, 100, 100);
+    outputModeBox.setBounds(startX + controlSpacing * 7, configY + 20, 120, 24);
+    midiCcSlider.setBounds(startX + controlSpacing * 7, configY + 76, 120, 24);
+    arpModeBox.setBounds(startX + controlSpacing * 8, configY + 20, 100, 24);
+    notePriorityBox.setBounds(startX + controlSpacing * 8, configY + 76, 100, 24);
+    mutationBox.setBounds(startX + controlSpacing * 9, configY + 20, 100, 24);
+    mutationRateSlider.setBounds(startX + controlSpacing * 9, configY + 68, 50, 42);
+    mutationDepthSlider.setBounds(startX + controlSpacing * 9 + 50, configY + 68, 50, 42);
+}
+
+void StepSequencerAudioProcessorEditor::refresh()
+{
+    TRACE_SCOPE("refresh");
+    // Idle frames return here: without new telemetry the audio thread hasn't
+    // run, so the playing pattern, the load and the analyzer are unchanged too
+    const int patternVersion = audioProcessor.getPatternVersion();
+    const int patternLength = audioProcessor.getPatternLength();
+    if (playbackSettled && !audioProcessor.hasTelemetry() && patternVersion == lastPatternVersion
+        && patternLength == lastPatternLength && !stepGrid.hasStagedEdits())
+        return;
+
+    // Refresh the knobs if the whole pattern was replaced (e.g. state load)
+    if (patternVersion != lastPatternVersion)
+    {
+        lastPatternVersion = patternVersion;
+        patternBox.setSelectedId(audioProcessor.getSelectedPattern() + 1, juce::dontSendNotification);
+        showPage(currentPage);
+    }
+
+    // Show which pattern is playing (it trails the selection until the switch boundary)
+    int activePattern = audioProcessor.getActivePattern();
+    if (activePattern != lastActivePattern)
+    {
+        lastActivePattern = activePattern;
+        playingLabel.setText("Playing " + juce::String(activePattern + 1), juce::dontSendNotification);
+    }
+
+    if (patternLength != lastPatternLength)
+    {
+        lastPatternLength = patternLength;
+        stepGrid.setLength(patternLength);
+        showPage(currentPage);
+    }
+
+    // Publish this frame's grid edits as one snapshot, then show them on the knobs
+    if (stepGrid.flush())
+        showPage(currentPage);
+
+    // Update current step display; only LEDs and grid cells that change repaint
+    if (updatePlayback())
+    {
+        updateLeds();
+        stepGrid.setPlayhead(lastDisplayedStep);
+    }
+
+    updateLoad();
+
+#if !JucePlugin_IsMidiEffect
+    analyzerView.update(audioProcessor.getAnalyzer(), audioProcessor.getSampleRate());
+#endif
+}
+
+void StepSequencerAudioProcessorEditor::updateLoad()
+{
+    // A few times a second is plenty for text
+    const auto now = juce::Time::getMillisecondCounter();
+    if (now - lastLoadUpdate < 250)
+        return;
+    lastLoadUpdate = now;
+
+    const auto &meter = audioProcessor.getLoadMeter();
+    const auto histogram = meter.getHistogram();
+    auto percent = [](float load)
+    { return juce::String(juce::roundToInt(load * 100.0f)) + "%"; };
+
+    loadLabel.setText("DSP " + percent(meter.getCurrent())
+                          + "  peak " + percent(LoadMeter::getPercentile(histogram, loadBaseline, 1.0f))
+                          + "  p99 " + percent(LoadMeter::getPercentile(histogram, loadBaseline, 0.99f)),
+                      juce::dontSendNotification);
+}
+
+void StepSequencerAudioProcessorEditor::updateLeds()
+{
+    int pageStart = currentPage * STEPS_PER_PAGE;
+    for (int i = 0; i < STEPS_PER_PAGE; ++i)
+    {
+        const int step = pageStart + i;
+        auto state = StepLed::State::idle;
+
+        // Highlight current step (brighter while its gate is open) and steps
+        // passed since the last frame, dim steps past the end of the pattern
+        if (step == lastDisplayedStep)
+            state = gateDisplayed ? StepLed::State::gate : StepLed::State::current;
+        else if (step < maxPatternSteps && stepsPassed[(size_t)step])
+            state = StepLed::State::passed;
+        else if (step >= lastPatternLength)
+            state = StepLed::State::inactive;
+
+        stepLeds[i].setState(state);
+    }
+}
+
+bool StepSequencerAudioProcessorEditor::updatePlayback()
+{
+    TelemetryEvent event;
+    while (audioProcessor.popTelemetry(event))
+    {
+        if (event.type == TelemetryEvent::Type::clock)
+        {
+            telemetryClock = event.time;
+            telemetryMilliseconds = event.milliseconds;
+            telemetrySampleRate = event.sampleRate;
+        }
+        else
+        {
+            pendingTelemetry.push_back(event);
+        }
+    }
+
+    if (telemetryClock < 0)
+    {
+        playbackSettled = pendingTelemetry.empty();
+        return false;
+    }
+
+    // Where the audio clock is now, extrapolated from the latest block
+    const auto elapsed = juce::Time::getMillisecondCounterHiRes() - telemetryMilliseconds;
+    const auto displayClock = telemetryClock + (int64_t)(elapsed * telemetrySampleRate / 1000.0);
+
+    // Steps shorter than a frame still light up for one frame
+    const auto previouslyPassed = stepsPassed;
+    stepsPassed.fill(false);
+    bool changed = false;
+
+    auto due = pendingTelemetry.begin();
+    for (; due != pendingTelemetry.end() && due->time <= displayClock; ++due)
+    {
+        switch (due->type)
+        {
+        case TelemetryEvent::Type::step:
+            lastDisplayedStep = due->step;
+            stepsPassed[(size_t)due->step] = true;
+            break;
+        case TelemetryEvent::Type::gateOn:
+            gateDisplayed = true;
+            noteLabel.setText(juce::MidiMessage::getMidiNoteName(due->note, true, true, 3), juce::dontSendNotification);
+            break;
+        case TelemetryEvent::Type::gateOff:
+            gateDisplayed = false;
+            break;
+        case TelemetryEvent::Type::stop:
+            lastDisplayedStep = -1;
+            gateDisplayed = false;
+            noteLabel.setText({}, juce::dontSendNotification);
+            break;
+        case TelemetryEvent::Type::clock:
+            break;
+        }
+        changed = true;
+    }
+    pendingTelemetry.erase(pendingTelemetry.begin(), due);
+
+    changed = changed || stepsPassed != previouslyPassed;
+    playbackSettled = pendingTelemetry.empty() && !changed;
+    return changed;
+}
+
+int StepSequencerAudioProcessorEditor::getNumPages() const
+{
+    return (audioProcessor.getPatternLength() + STEPS_PER_PAGE - 1) / STEPS_PER_PAGE;
 }
 
-void StepSequencerAudioProcessorEditor::timerCallback()
+void StepSequencerAudioProcessorEditor::showPage(int page)
 {
-    // Update current step display
-    int currentStep = audioProcessor.getCurrentStep();
-    if (currentStep != lastDisplayedStep)
+    currentPage = juce::jlimit(0, getNumPages() - 1, page);
+    int pageStart = currentPage * STEPS_PER_PAGE;
+    const auto &lane = getLaneInfo(currentLane);
+
+    for (int i = 0; i < STEPS_PER_PAGE; ++i)
     {
-        lastDisplayedStep = currentStep;
-        repaint();
+        auto &slider = stepSliders[i];
+        slider.setRange(lane.minValue, lane.maxValue, lane.interval);
+        slider.setDoubleClickReturnValue(true, lane.defaultValue);
+        slider.setTextValueSuffix(currentLane == StepLane::pitch ? " st" : "");
+
+        // Conditions are shown by name
+        if (currentLane == StepLane::condition)
+            slider.textFromValueFunction = [](double value)
+            { return juce::String(trigConditions[juce::jlimit(0, numTrigConditions - 1, juce::roundToInt(value))].name); };
+        else
+            slider.textFromValueFunction = nullptr;
+
+        slider.setValue(audioProcessor.getStepValue(currentLane, pageStart + i), juce::dontSendNotification);
+        slider.updateText();
+        stepLabels[i].setText(juce::String(pageStart + i + 1), juce::dontSendNotification);
     }
-}
\ No newline at end of file
+
+    pageLabel.setText("Page " + juce::String(currentPage + 1) + " / " + juce::String(getNumPages()),
+                      juce::dontSendNotification);
+    prevPageButton.setEnabled(currentPage > 0);
+    nextPageButton.setEnabled(currentPage < getNumPages() - 1);
+    updateLeds();
+    stepGrid.reload();
+}
+
+void StepSequencerAudioProcessorEditor::showEditMenu()
+{
+    const auto lane = currentLane;
+    const auto &info = getLaneInfo(lane);
+    const int length = audioProcessor.getPatternLength();
+
+    // Each menu item edits the whole pattern and publishes it once
+    auto applyEdit = [this](std::function<void(Pattern &)> edit)
+    {
+        return [this, edit]
+        {
+            stepGrid.flush();
+            audioProcessor.modifyPattern(edit);
+            showPage(currentPage);
+        };
+    };
+
+    juce::PopupMenu menu;
+    menu.addItem("Randomize " + juce::String(info.name), applyEdit([lane, length](Pattern &pattern)
+                                                                   {
+        const auto &laneInfo = getLaneInfo(lane);
+        auto &random = juce::Random::getSystemRandom();
+        for (int i = 0; i < length; ++i)
+        {
+            float value = laneInfo.minValue + random.nextFloat() * (laneInfo.maxValue - laneInfo.minValue);
+            if (lane == StepLane::pitch)
+                value = std::round(value); // whole semitones
+            pattern.setValue(lane, i, value);
+        } }));
+    menu.addItem("Reset " + juce::String(info.name), applyEdit([lane](Pattern &pattern)
+                                                               {
+        for (int i = 0; i < maxPatternSteps; ++i)
+            pattern.setValue(lane, i, getLaneInfo(lane).defaultValue); }));
+    menu.addSeparator();
+    menu.addItem("Shift Left", applyEdit([length](Pattern &pattern)
+                                         { pattern.rotate(-1, length); }));
+    menu.addItem("Shift Right", applyEdit([length](Pattern &pattern)
+                                          { pattern.rotate(1, length); }));
+    menu.addSeparator();
+    menu.addItem("Euclidean...", [this]
+                 { showEuclideanPanel(); });
+    menu.addSeparator();
+    menu.addItem("Open Library...", [this]
+                 { openLibrary(); });
+    menu.addItem("Browse Library...", library.isOpen(), false, [this]
+                 { showLibraryPanel(); });
+    menu.addItem("Save Bank as Library...", [this]
+                 { saveLibrary(); });
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&editButton));
+}
+
+void StepSequencerAudioProcessorEditor::showEuclideanPanel()
+{
+    const int steps = audioProcessor.getPatternLength();
+    auto panel = std::make_unique<EuclideanPanel>(juce::jmin(euclideanHits, steps), steps,
+                                                  juce::jmin(euclideanRotation, steps - 1));
+    panel->onChange = [this](int hits, int newSteps, int rotation)
+    {
+        euclideanHits = hits;
+        euclideanRotation = rotation;
+        stepGrid.flush();
+        audioProcessor.generateEuclidean(hits, newSteps, rotation);
+        showPage(currentPage);
+    };
+
+    juce::CallOutBox::launchAsynchronously(std::move(panel), editButton.getBoundsInParent(), this);
+}
+
+void StepSequencerAudioProcessorEditor::openLibrary()
+{
+    libraryChooser = std::make_unique<juce::FileChooser>("Open pattern library", library.getFile(), "*.seqlib");
+    libraryChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                [this](const juce::FileChooser &chooser)
+                                {
+        auto file = chooser.getResult();
+        if (!file.existsAsFile())
+            return;
+
+        if (library.open(file))
+            showLibraryPanel();
+        else
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Pattern Library",
+                                                   file.getFileName() + " is not a pattern library for this version"); });
+}
+
+void StepSequencerAudioProcessorEditor::saveLibrary()
+{
+    libraryChooser = std::make_unique<juce::FileChooser>("Save bank as pattern library", library.getFile(), "*.seqlib");
+    libraryChooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+                                    | juce::FileBrowserComponent::warnAboutOverwriting,
+                                [this](const juce::FileChooser &chooser)
+                                {
+        auto file = chooser.getResult();
+        if (file == juce::File())
+            return;
+
+        file = file.withFileExtension("seqlib");
+
+        // Some systems can't replace a file while it is mapped
+        const bool reopen = file == library.getFile();
+        if (reopen)
+            library.close();
+
+        if (!audioProcessor.saveBankToLibrary(file))
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Pattern Library",
+                                                   "Could not write " + file.getFileName());
+
+        if (reopen)
+            library.open(file); });
+}
+
+void StepSequencerAudioProcessorEditor::showLibraryPanel()
+{
+    auto panel = std::make_unique<LibraryPanel>(library);
+    panel->onLoad = [this](int index)
+    {
+        stepGrid.flush();
+        audioProcessor.loadLibraryPattern(library, index);
+        showPage(currentPage);
+    };
+
+    juce::CallOutBox::launchAsynchronously(std::move(panel), editButton.getBoundsInParent(), this);
+}
+
+void StepSequencerAudioProcessorEditor::showGrooveMenu()
+{
+    juce::PopupMenu menu;
+    menu.addItem("Load MIDI Groove...", [this]
+                 {
+        grooveChooser = std::make_unique<juce::FileChooser>("Load groove", juce::File(), "*.mid;*.midi");
+        grooveChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                   [this](const juce::FileChooser &chooser)
+                                   {
+            auto file = chooser.getResult();
+            if (file.existsAsFile() && !audioProcessor.loadGroove(file))
+                juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Groove",
+                                                       "No usable groove found in " + file.getFileName());
+        }); });
+    menu.addItem("Clear Groove", audioProcessor.hasGroove(), false, [this]
+                 { audioProcessor.clearGroove(); });
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&grooveButton));
+}
+
+void StepSequencerAudioProcessorEditor::showTuningMenu()
+{
+    juce::PopupMenu menu;
+    menu.addSectionHeader(audioProcessor.getTuningName());
+    menu.addItem("Load Scala Tuning...", [this]
+                 {
+        tuningChooser = std::make_unique<juce::FileChooser>("Load tuning", juce::File(), "*.scl;*.kbm");
+        tuningChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                   [this](const juce::FileChooser &chooser)
+                                   {
+            auto file = chooser.getResult();
+            if (file.existsAsFile() && !audioProcessor.loadTuning(file))
+                juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Tuning",
+                                                       file.getFileName() + " is not a valid Scala scale or keyboard mapping");
+        }); });
+    menu.addItem("Reset to 12-TET", audioProcessor.hasTuning(), false, [this]
+                 { audioProcessor.resetTuning(); });
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&tuningButton));
+}
@@ -2,9 +2,14 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "RefreshDriver.h"
+#include "StepLed.h"
+#include "EditorChrome.h"
+#include "StepGrid.h"
+#include "AnalyzerView.h"
 
 class StepSequencerAudioProcessorEditor : public juce::AudioProcessorEditor,
-                                          private juce::Timer
+                                          private RefreshDriver::Client
 {
 public:
     StepSequencerAudioProcessorEditor(StepSequencerAudioProcessor &);
@@ -12,16 +17,89 @@ public:
 
     void paint(juce::Graphics &) override;
     void resized() override;
-    void timerCallback() override;
+    void visibilityChanged() override;
+    void parentHierarchyChanged() override;
 
 private:
     StepSequencerAudioProcessor &audioProcessor;
 
-    // Step sequencer knobs and LEDs
-    static constexpr int NUM_STEPS = 8;
-    std::array<juce::Slider, NUM_STEPS> stepSliders;
-    std::array<std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>, NUM_STEPS> stepAttachments;
-    std::array<juce::Label, NUM_STEPS> stepLabels;
+    // Per-frame updates come from the refresh tick shared by all open editors
+    juce::SharedResourcePointer<RefreshDriver> refreshDriver;
+    void refresh() override;
+
+    // Step sequencer knobs and LEDs, showing one page of the pattern at a time
+    static constexpr int STEPS_PER_PAGE = 8;
+    std::array<juce::Slider, STEPS_PER_PAGE> stepSliders;
+    std::array<juce::Label, STEPS_PER_PAGE> stepLabels;
+    std::array<StepLed, STEPS_PER_PAGE> stepLeds;
+    void updateLeds();
+
+    // All lanes and steps at once, scrolled in a viewport
+    juce::Viewport gridViewport;
+    StepGrid stepGrid{audioProcessor};
+
+#if !JucePlugin_IsMidiEffect
+    // Scope and spectrum of the synth output, fed only while this editor exists
+    AnalyzerView analyzerView;
+#endif
+
+    // Static chrome (panels and titles), rendered once per size and display
+    // scale instead of on every repaint
+    juce::Image backgroundCache;
+    void renderBackground(juce::Graphics &g);
+
+    juce::TextButton prevPageButton{"<"};
+    juce::TextButton nextPageButton{">"};
+    juce::Label pageLabel;
+    int currentPage = 0;
+
+    // Bank pattern being edited, and the one currently playing
+    juce::ComboBox patternBox;
+    juce::Label playingLabel;
+    int lastActivePattern = -1;
+
+    juce::ComboBox switchQuantizeBox;
+    juce::Label switchQuantizeLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> switchQuantizeAttachment;
+
+    // Conditional trig fill and the seed of the generative decisions
+    juce::TextButton fillButton{"Fill"};
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> fillAttachment;
+
+    juce::Slider seedSlider;
+    juce::Label seedLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> seedAttachment;
+
+    // Scale quantizer
+    juce::ComboBox scaleBox;
+    juce::Label scaleLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> scaleAttachment;
+
+    juce::ComboBox keyBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> keyAttachment;
+
+    // Which per-step lane the knobs edit
+    juce::ComboBox laneBox;
+    StepLane currentLane = StepLane::pitch;
+
+    // Bulk pattern operations (each one publishes a single snapshot)
+    juce::TextButton editButton{"Edit"};
+    void showEditMenu();
+
+    // Euclidean generator settings, kept between openings of its panel
+    int euclideanHits = 4;
+    int euclideanRotation = 0;
+    void showEuclideanPanel();
+
+    // Pattern library file, mapped while open and browsed from the Edit menu
+    PatternLibrary library;
+    std::unique_ptr<juce::FileChooser> libraryChooser;
+    void openLibrary();
+    void saveLibrary();
+    void showLibraryPanel();
+
+    void showPage(int page);
+    int getNumPages() const;
 
     // Config section
     juce::Slider rateSlider;
@@ -35,12 +113,84 @@ private:
     juce::ToggleButton glideToggle;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> glideAttachment;
 
+    juce::Slider swingSlider;
+    juce::Label swingLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> swingAttachment;
+
+    juce::TextButton grooveButton{"Groove"};
+    std::unique_ptr<juce::FileChooser> grooveChooser;
+    void showGrooveMenu();
+
+    juce::TextButton tuningButton{"Tuning"};
+    std::unique_ptr<juce::FileChooser> tuningChooser;
+    void showTuningMenu();
+
     juce::Slider glideTimeSlider;
     juce::Label glideTimeLabel;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> glideTimeAttachment;
 
+    juce::Slider lengthSlider;
+    juce::Label lengthLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> lengthAttachment;
+
+    juce::ComboBox outputModeBox;
+    juce::Label outputModeLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> outputModeAttachment;
+
+    juce::Slider midiCcSlider;
+    juce::Label midiCcLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> midiCcAttachment;
+
+    // How held keys drive the sequence
+    juce::ComboBox arpModeBox;
+    juce::Label arpModeLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> arpModeAttachment;
+
+    juce::ComboBox notePriorityBox;
+    juce::Label notePriorityLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> notePriorityAttachment;
+
+    // Background pattern mutation
+    juce::ComboBox mutationBox;
+    juce::Label mutationLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> mutationAttachment;
+
+    juce::Slider mutationRateSlider;
+    juce::Label mutationRateLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> mutationRateAttachment;
+
+    juce::Slider mutationDepthSlider;
+    juce::Label mutationDepthLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> mutationDepthAttachment;
+
+    juce::ComboBox controlRateBox;
+    juce::Label controlRateLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> controlRateAttachment;
+
+    // Playback display, fed by the processor's telemetry ring. Events are held
+    // back until the time they are heard, using the block clock events to map
+    // sample times to wall time.
+    std::vector<TelemetryEvent> pendingTelemetry;
+    int64_t telemetryClock = -1;
+    double telemetryMilliseconds = 0.0;
+    double telemetrySampleRate = 44100.0;
+    bool playbackSettled = false; // nothing pending and nothing changed on the last frame
+    bool updatePlayback();
+
+    bool gateDisplayed = false;
+    std::array<bool, maxPatternSteps> stepsPassed{}; // steps played since the previous frame
+    juce::Label noteLabel;
+
+    // This instance's DSP load: current, and peak and p99 since the editor opened
+    juce::Label loadLabel;
+    LoadMeter::Histogram loadBaseline{};
+    juce::uint32 lastLoadUpdate = 0;
+    void updateLoad();
+
     // Current step indicator (for LED)
     int lastDisplayedStep = -1;
+    int lastPatternLength = -1;
+    int lastPatternVersion = -1;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StepSequencerAudioProcessorEditor)
 };
\ No newline at end of file
@@ -1,15 +1,34 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "Euclidean.h"
 
 StepSequencerAudioProcessor::StepSequencerAudioProcessor()
+#if JucePlugin_IsMidiEffect
+    : AudioProcessor(BusesProperties()), // MIDI effect build: no audio buses at all
+#else
     : AudioProcessor(BusesProperties()
                          .withOutput("Output", juce::AudioChannelSet::mono(), true)),
+#endif
       apvts(*this, nullptr, "Parameters", createParameterLayout())
 {
+    mutator.setSource(editPatterns[0], 0);
+    swingParameter = apvts.getParameter("swing");
+    lengthValue = apvts.getRawParameterValue("length");
+    patternParameter = apvts.getParameter("pattern");
+    patternValue = apvts.getRawParameterValue("pattern");
+    switchQuantizeValue = apvts.getRawParameterValue("switch_quantize");
+
+    for (auto *parameter : getParameters())
+        parameter->addListener(this);
+    captureState();
+    startTimer(500);
 }
 
 StepSequencerAudioProcessor::~StepSequencerAudioProcessor()
 {
+    stopTimer();
+    for (auto *parameter : getParameters())
+        parameter->removeListener(this);
 }
 
 // Define NoteDivision struct
@@ -65,19 +84,15 @@ juce::AudioProcessorValueTreeState::ParameterLayout StepSequencerAudioProcessor:
 {
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
 
-    // 8 step pitch parameters (±12 semitones)
-    for (int i = 0; i < NUM_STEPS; ++i)
-    {
-        params.push_back(std::make_unique<juce::AudioParameterFloat>(
-            juce::ParameterID("step" + juce::String(i), 1),
-            "Step " + juce::String(i + 1),
-            juce::NormalisableRange<float>(-12.0f, 12.0f, 0.01f),
-            0.0f,
-            juce::AudioParameterFloatAttributes()
-                .withLabel("st")
-                .withStringFromValueFunction([](float value, int)
-                                             { return juce::String(value, 1); })));
-    }
+    // Step pitches live in the engine's pattern storage, not in host parameters.
+    // Only the pattern length is exposed, so the parameter count stays fixed.
+    params.push_back(std::make_unique<juce::AudioParameterInt>(
+        juce::ParameterID("length", 1),
+        "Length",
+        1, maxPatternSteps,
+        defaultPatternLength,
+        juce::AudioParameterIntAttributes()
+            .withLabel("steps")));
 
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         juce::ParameterID("rate", 1),
@@ -101,12 +116,26 @@ juce::AudioProcessorValueTreeState::ParameterLayout StepSequencerAudioProcessor:
             .withStringFromValueFunction([](float value, int)
                                          { return juce::String((int)(value * 100)) + "%"; })));
 
+    // Swing: share of each step pair taken by its first step
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("swing", 1),
+        "Swing",
+        juce::NormalisableRange<float>(0.5f, 0.75f, 0.01f),
+        0.5f,
+        juce::AudioParameterFloatAttributes()
+            .withLabel("%")
+            .withStringFromValueFunction([](float value, int)
+                                         { return juce::String(juce::roundToInt(value * 100)) + "%"; })));
+
     // Glide enable
     params.push_back(std::make_unique<juce::AudioParameterBool>(
         juce::ParameterID("glide_enable", 1),
         "Glide",
         false));
 
+#if !JucePlugin_IsMidiEffect
+    // Synth-only parameters; the MIDI effect build has no DSP to control
+
     // Glide time in milliseconds
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         juce::ParameterID("glide_time", 1),
@@ -118,37 +147,167 @@ juce::AudioProcessorValueTreeState::ParameterLayout StepSequencerAudioProcessor:
             .withStringFromValueFunction([](float value, int)
                                          { return juce::String((int)value) + " ms"; })));
 
+    // Control quantum: glide and modulation are evaluated once per this many samples
+    juce::StringArray quantumLabels;
+    for (auto size : controlQuantumSizes)
+        quantumLabels.add(juce::String(size) + " smp");
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("control_rate", 1),
+        "Control Rate",
+        quantumLabels,
+        defaultControlQuantumIndex));
+
+    // Output: the built-in synth, MIDI to drive other instruments, or both
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("output_mode", 1),
+        "Output",
+        juce::StringArray{"Audio", "MIDI", "Audio + MIDI"},
+        0));
+#endif
+
+    // Controller sent with every step in MIDI output mode (from the CC lane)
+    params.push_back(std::make_unique<juce::AudioParameterInt>(
+        juce::ParameterID("midi_cc", 1),
+        "MIDI CC",
+        0, 119,
+        0,
+        juce::AudioParameterIntAttributes()
+            .withStringFromValueFunction([](int value, int)
+                                         { return value == 0 ? juce::String("Off") : "CC " + juce::String(value); })));
+
+    // Bank pattern selection for host automation; a change queues a switch
+    params.push_back(std::make_unique<juce::AudioParameterInt>(
+        juce::ParameterID("pattern", 1),
+        "Pattern",
+        1, numBankPatterns,
+        1));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("switch_quantize", 1),
+        "Pattern Switch",
+        juce::StringArray{"Step", "Beat", "Bar"},
+        (int)SwitchQuantize::bar));
+
+    // Held keys are either played through the arpeggiator or reduced to one base note
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("arp_mode", 1),
+        "Arp",
+        juce::StringArray{"Off", "Up", "Down", "Up-Down", "Random", "As Played"},
+        (int)ArpMode::off));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("note_priority", 1),
+        "Note Priority",
+        juce::StringArray{"Last", "Low", "High"},
+        (int)NotePriority::last));
+
+    // Conditional trigs: "Fill" steps play only while fill is on
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID("fill", 1),
+        "Fill",
+        false));
+
+    // Seed for probability, conditions and the random arp order
+    params.push_back(std::make_unique<juce::AudioParameterInt>(
+        juce::ParameterID("seed", 1),
+        "Seed",
+        1, 9999,
+        1));
+
+    // Scale quantizer: "Off" keeps step pitches continuous
+    juce::StringArray scaleNames{"Off"};
+    for (const auto &scale : scales)
+        scaleNames.add(scale.name);
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("scale", 1),
+        "Scale",
+        scaleNames,
+        0));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("key", 1),
+        "Key",
+        juce::StringArray{"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"},
+        0));
+
+    // Background pattern mutation: how many steps change per bar, and how far
+    // from the edited pattern they may drift
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("mutation", 1),
+        "Mutation",
+        juce::StringArray{"Off", "Markov", "Random Walk"},
+        (int)MutationMode::off));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("mutation_rate", 1),
+        "Mutation Rate",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+        0.25f,
+        juce::AudioParameterFloatAttributes()
+            .withLabel("%")
+            .withStringFromValueFunction([](float value, int)
+                                         { return juce::String(juce::roundToInt(value * 100)) + "%"; })));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("mutation_depth", 1),
+        "Mutation Depth",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+        0.25f,
+        juce::AudioParameterFloatAttributes()
+            .withLabel("%")
+            .withStringFromValueFunction([](float value, int)
+                                         { return juce::String(juce::roundToInt(value * 100)) + "%"; })));
+
     return {params.begin(), params.end()};
 }
 
 void StepSequencerAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    juce::ignoreUnused(sampleRate, samplesPerBlock);
+    loadMeter.prepare(sampleRate);
     phase = 0.0f;
+
+    // Room for a full timeline of events per chunk, plus CC and note-off
+    // extras, so writing MIDI never allocates on the audio thread
+    const int maxEventsPerBlock = (samplesPerBlock / maxTimelineChunk + 1) * BlockTimeline::capacity * 2;
+    outputMidi.ensureSize((size_t)maxEventsPerBlock * 16);
+    outputMidi.clear();
+    midiNoteOut = -1;
     currentFrequency = 440.0f;
     targetFrequency = 440.0f;
     resetSequencer();
+    mutator.start();
 }
 
 void StepSequencerAudioProcessor::releaseResources()
 {
+    mutator.stop();
 }
 
 bool StepSequencerAudioProcessor::isBusesLayoutSupported(const BusesLayout &layouts) const
 {
+#if JucePlugin_IsMidiEffect
+    return layouts.outputBuses.isEmpty() && layouts.inputBuses.isEmpty();
+#else
     return layouts.getMainOutputChannelSet() == juce::AudioChannelSet::mono();
+#endif
 }
 
 void StepSequencerAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
 {
+    LoadMeter::ScopedBlock blockTiming(loadMeter, buffer.getNumSamples());
+    TRACE_SCOPE("processBlock");
     juce::ScopedNoDenormals noDenormals;
     buffer.clear();
 
+    bool hasPosition = false;
     if (auto *playHead = getPlayHead())
     {
         if (auto posInfo = playHead->getPosition())
         {
             lastPosInfo = *posInfo;
+            hasPosition = true;
 
             if (auto bpmOpt = lastPosInfo.getBpm())
             {
@@ -157,18 +316,40 @@ void StepSequencerAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
         }
     }
 
+    TRACE_BEGIN(parameters, "parameters");
     double bpm = currentBpm.load();
     double sampleRate = getSampleRate();
 
     auto rateParam = apvts.getRawParameterValue("rate")->load();
-    auto gateParam = apvts.getRawParameterValue("gate")->load();
+    gateAmount = apvts.getRawParameterValue("gate")->load();
     auto glideEnable = apvts.getRawParameterValue("glide_enable")->load() > 0.5f;
-    auto glideTimeMs = apvts.getRawParameterValue("glide_time")->load();
 
     stepLengthInSamples = calculateStepLength(sampleRate, rateParam);
+    patternLength = juce::jlimit(1, maxPatternSteps, (int)lengthValue->load());
+    glideEnabled = glideEnable;
+
+    // Recompile the groove table only when the groove or swing changed; a new
+    // step length just rescales it
+    const bool swingDirty = swingChanged.exchange(false);
+    if (groovePublisher.acquire() || swingDirty)
+        grooveTable.compile(groovePublisher.getLive(), apvts.getRawParameterValue("swing")->load());
+    grooveTable.setStepLength(stepLengthInSamples);
+
+    // A new tuning only affects notes scheduled from here on
+    tuningPublisher.acquire();
 
-    // Calculate glide rate (frequency change per sample)
-    if (glideEnable && glideTimeMs > 0.0f)
+#if JucePlugin_IsMidiEffect
+    // The MIDI effect build only advances the clock and emits events
+    midiOutputEnabled = true;
+#else
+    auto outputMode = (int)apvts.getRawParameterValue("output_mode")->load();
+    const bool renderAudio = outputMode != 1;
+    midiOutputEnabled = outputMode != 0;
+
+    // Calculate glide rate (frequency change per sample). Slide steps glide
+    // even when glide is off, so the rate is always kept up to date.
+    auto glideTimeMs = apvts.getRawParameterValue("glide_time")->load();
+    if (glideTimeMs > 0.0f)
     {
         float glideTimeSamples = (glideTimeMs / 1000.0f) * sampleRate;
         glideRate = 1.0f / glideTimeSamples;
@@ -178,105 +359,489 @@ void StepSequencerAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
         glideRate = 1.0f; // Instant change
     }
 
+    auto quantumIndex = (int)apvts.getRawParameterValue("control_rate")->load();
+    controlQuantum = controlQuantumSizes[juce::jlimit(0, (int)std::size(controlQuantumSizes) - 1, quantumIndex)];
+#endif
+    midiCcNumber = (int)apvts.getRawParameterValue("midi_cc")->load();
+    arpMode = (ArpMode)(int)apvts.getRawParameterValue("arp_mode")->load();
+    notePriority = (NotePriority)(int)apvts.getRawParameterValue("note_priority")->load();
+    fillActive = apvts.getRawParameterValue("fill")->load() > 0.5f;
+    randomSeed = (uint32_t)apvts.getRawParameterValue("seed")->load();
+    const bool mutation = (MutationMode)(int)apvts.getRawParameterValue("mutation")->load() != MutationMode::off;
+    const int scale = (int)apvts.getRawParameterValue("scale")->load() - 1;
+    const int key = (int)apvts.getRawParameterValue("key")->load();
+    if (mutation != mutationEnabled || scale != scaleIndex)
+        stepNotesDirty = true;
+    mutationEnabled = mutation;
+    scaleIndex = scale;
+    scaleKey = key;
+    TRACE_END(parameters);
+
+    outputMidi.clear();
+    blockStartClock = sampleClock;
+    updateBarGrid(hasPosition, sampleRate);
+
+    // Lets the editor map event times to wall time
+    TelemetryEvent clockEvent;
+    clockEvent.time = sampleClock;
+    clockEvent.milliseconds = juce::Time::getMillisecondCounterHiRes();
+    clockEvent.sampleRate = sampleRate;
+    telemetry.push(clockEvent);
+
+    // Don't leave a note hanging when MIDI output is switched off
+    if (!midiOutputEnabled)
+        emitMidiNoteOff(0);
+
+    // Collect pattern change requests: host automation, then the editor queue, then MIDI
+    auto patternParam = (int)patternValue->load() - 1;
+    if (lastPatternParam >= 0 && patternParam != lastPatternParam)
+        requestedPattern = patternParam;
+    lastPatternParam = patternParam;
+
+    int queuedPattern;
+    while (patternChanges.pop(queuedPattern))
+        requestedPattern = queuedPattern;
+
     // Process MIDI
+    TRACE_BEGIN(midi, "midi");
     for (const auto metadata : midiMessages)
     {
         auto msg = metadata.getMessage();
 
-        if (msg.isNoteOn())
+        if (msg.isProgramChange())
         {
-            isNoteOn = true;
-            baseNote = msg.getNoteNumber();
-            resetSequencer();
-            gateIsOn = true;
-            gateOffSamples = stepLengthInSamples * gateParam;
+            requestedPattern = msg.getProgramChangeNumber() % numBankPatterns;
         }
-        else if (msg.isNoteOff())
+        else if (msg.isNoteOn())
         {
-            isNoteOn = false;
-            gateIsOn = false;
+            // The first key restarts the sequence; further keys only join the
+            // held set and are picked up at the next step
+            const bool restart = heldNotes.isEmpty();
+            heldNotes.add(msg.getNoteNumber());
+
+            if (restart)
+            {
+                isNoteOn = true;
+                emitMidiNoteOff(metadata.samplePosition);
+                resetSequencer();
+            }
+        }
+        else if (msg.isNoteOff() || msg.isAllNotesOff() || msg.isAllSoundOff())
+        {
+            if (msg.isNoteOff())
+                heldNotes.remove(msg.getNoteNumber());
+            else
+                heldNotes.clear();
+
+            // Playback stops only once the last held key is released
+            if (heldNotes.isEmpty())
+            {
+                isNoteOn = false;
+                gateIsOn = false;
+                emitMidiNoteOff(metadata.samplePosition);
+                pushTelemetry(TelemetryEvent::Type::stop, sampleClock + metadata.samplePosition);
+            }
         }
     }
 
+    TRACE_END(midi);
+
+    const int numSamples = buffer.getNumSamples();
+
     if (!isNoteOn)
+    {
+        // Nothing is playing, so there is no boundary to wait for
+        applyRequestedPattern();
+        sampleClock += numSamples;
+        midiMessages.clear();
+        midiMessages.addEvents(outputMidi, 0, numSamples, 0);
         return;
+    }
 
-    auto *outputData = buffer.getWritePointer(0);
-
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+    // Work through the block in chunks: every step that falls in the chunk is
+    // first scheduled onto the timeline (with its ratchets and micro-timing),
+    // then audio is rendered from event to event. Segments are at most one
+    // control quantum long, and nothing is tested per sample.
+    int sample = 0;
+#if !JucePlugin_IsMidiEffect
+    bool audible = false; // any segment rendered with the gate open
+#endif
+    while (sample < numSamples)
     {
-        // Check if we need to advance to next step
-        if (samplesUntilNextStep <= 0.0)
+        const int chunkEnd = juce::jmin(numSamples, sample + maxTimelineChunk);
+        scheduleSteps(sampleClock + (chunkEnd - sample));
+
+        while (sample < chunkEnd)
         {
-            advanceStep();
-            samplesUntilNextStep = stepLengthInSamples;
-            gateOffSamples = stepLengthInSamples * gateParam;
-            gateIsOn = true;
-        }
+            while (timeline.getNextEventTime() <= sampleClock)
+                applyEvent(timeline.pop());
 
-        // Check gate
-        if (gateOffSamples <= 0.0)
-            gateIsOn = false;
+            int segment = (int)juce::jmin((int64_t)(chunkEnd - sample),
+                                          timeline.getNextEventTime() - sampleClock);
 
-        // Apply glide to frequency
-        if (currentFrequency != targetFrequency)
-        {
-            if (glideRate >= 1.0f)
+#if !JucePlugin_IsMidiEffect
+            // In MIDI-only mode there is nothing to render between events
+            if (renderAudio)
             {
-                currentFrequency = targetFrequency;
+                segment = juce::jmin(segment, controlQuantum);
+                audible = audible || gateIsOn;
+                renderSegment(buffer.getWritePointer(0) + sample, segment);
             }
-            else
-            {
-                float diff = targetFrequency - currentFrequency;
-                currentFrequency += diff * glideRate;
+#endif
 
-                // Snap to target if very close
-                if (std::abs(targetFrequency - currentFrequency) < 0.1f)
-                    currentFrequency = targetFrequency;
-            }
+            sample += segment;
+            sampleClock += segment;
         }
+    }
+
+    // Copy the generated events to the host (the input has been consumed).
+    // 'outputMidi' keeps its reserved storage for the next block.
+    midiMessages.clear();
+    midiMessages.addEvents(outputMidi, 0, numSamples, 0);
+
+#if !JucePlugin_IsMidiEffect
+    // Silent blocks aren't sent, so the analyzer only repaints for sound
+    if (audible)
+        analyzer.push(buffer.getReadPointer(0), numSamples);
+#endif
+}
+
+#if !JucePlugin_IsMidiEffect
+void StepSequencerAudioProcessor::renderSegment(float *output, int numSamples)
+{
+    const float invSampleRate = 1.0f / (float)getSampleRate();
+
+    // Control rate: evaluate glide at the segment end, then interpolate across it
+    const float startFrequency = currentFrequency;
+    advanceGlide(numSamples);
+
+    phase = renderSawSegment(output, numSamples, phase,
+                             startFrequency * invSampleRate,
+                             currentFrequency * invSampleRate,
+                             gateIsOn ? 0.3f * noteVelocity : 0.0f); // Saw wave with volume scaling
+}
 
-        // Generate saw wave
-        float output = 0.0f;
-        if (gateIsOn)
+void StepSequencerAudioProcessor::advanceGlide(int numSamples)
+{
+    // Already there, within the snap tolerance below
+    if (std::abs(targetFrequency - currentFrequency) < 0.1f)
+    {
+        currentFrequency = targetFrequency;
+        return;
+    }
+
+    if (glideRate >= 1.0f)
+    {
+        currentFrequency = targetFrequency;
+        return;
+    }
+
+    // Closed form of numSamples iterations of: current += (target - current) * glideRate
+    float decay = std::pow(1.0f - glideRate, (float)numSamples);
+    currentFrequency = targetFrequency + (currentFrequency - targetFrequency) * decay;
+
+    // Snap to target if very close
+    if (std::abs(targetFrequency - currentFrequency) < 0.1f)
+        currentFrequency = targetFrequency;
+}
+#endif
+
+void StepSequencerAudioProcessor::updateBarGrid(bool hasPosition, double sampleRate)
+{
+    // A beat is the time signature's denominator, so 6/8 has two sixteenth
+    // steps per beat and twelve per bar
+    int numerator = 4, denominator = 4;
+    if (hasPosition)
+        if (auto timeSignature = lastPosInfo.getTimeSignature())
         {
-            output = (phase * 2.0f - 1.0f) * 0.3f; // Saw wave with volume scaling
+            numerator = juce::jlimit(1, 64, timeSignature->numerator);
+            denominator = juce::jlimit(1, 16, timeSignature->denominator);
         }
 
-        outputData[sample] = output;
+    stepsPerBeat = juce::jmax(1, 16 / denominator);
+    stepsPerBar = stepsPerBeat * numerator;
+    beatLengthPpq = 4.0 / denominator;
+    barLengthPpq = beatLengthPpq * numerator;
+
+    // Bars follow the host only while its transport moves
+    const auto ppq = hasPosition ? lastPosInfo.getPpqPosition() : juce::Optional<double>();
+    const auto bpm = hasPosition ? lastPosInfo.getBpm() : juce::Optional<double>();
+    hostGrid = lastPosInfo.getIsPlaying() && ppq.hasValue() && bpm.hasValue() && *bpm > 0.0 && sampleRate > 0.0;
+    if (!hostGrid)
+        return;
+
+    blockStartPpq = *ppq;
+    ppqPerSample = *bpm / (60.0 * sampleRate);
+
+    // Hosts that don't report the bar start count bars from the song start
+    barStartPpq = lastPosInfo.getPpqPositionOfLastBarStart().orFallback(0.0);
+}
+
+StepPosition StepSequencerAudioProcessor::getStepPosition(double stepTime) const
+{
+    if (!hostGrid)
+        return {stepClock % stepsPerBeat == 0, stepClock % stepsPerBar == 0};
+
+    // A step starts a beat or bar if the boundary falls within the step's
+    // length before it. The small bias keeps steps that land exactly on a
+    // boundary from missing it through rounding.
+    const double stepPpq = stepLengthInSamples * ppqPerSample;
+    const double intoBar = blockStartPpq - barStartPpq + (stepTime - (double)blockStartClock) * ppqPerSample + 1.0e-6;
+
+    auto startsUnit = [stepPpq, intoBar](double unit)
+    { return intoBar - unit * std::floor(intoBar / unit) < stepPpq; };
+
+    return {startsUnit(beatLengthPpq), startsUnit(barLengthPpq)};
+}
+
+const Pattern &StepSequencerAudioProcessor::advanceStep(double stepTime)
+{
+    TRACE_SCOPE("advanceStep");
+    scheduledStep = (scheduledStep + 1) % patternLength;
+    ++stepClock;
+
+    // Each loop draws from a stream that depends only on the seed and the loop
+    // number, so replaying from the same position gives identical results
+    if (scheduledStep == 0)
+        random.setSeed(((uint64_t)randomSeed << 32) ^ (uint64_t)++patternLoop);
 
-        // Update phase
-        phase += currentFrequency / (float)sampleRate;
-        if (phase >= 1.0f)
-            phase -= 1.0f;
+    // Queued pattern changes land on the chosen step/beat/bar boundary
+    const auto position = getStepPosition(stepTime);
+    auto quantize = (SwitchQuantize)(int)switchQuantizeValue->load();
+    if (isSwitchBoundary(quantize, position))
+        applyRequestedPattern();
 
-        samplesUntilNextStep -= 1.0;
-        gateOffSamples -= 1.0;
+    // Bar boundary: move to the mutator's generation for the new bar. Bars are
+    // counted even while mutation is off, so the generations stay keyed to them.
+    if (position.barStart && mutator.acquire(isNonRealtime()) && mutationEnabled)
+        stepNotesDirty = true;
+
+    // Step boundary: switch to the newest published snapshot of the active pattern, if any
+    auto &publisher = bank[(size_t)activePattern];
+    if (publisher.acquire())
+        stepNotesDirty = true;
+
+    // Mutations only apply while their source is the pattern playing
+    if (mutationEnabled && mutator.getLive().bankIndex == activePattern)
+        return mutator.getLive().pattern;
+
+    return publisher.getLive();
+}
+
+void StepSequencerAudioProcessor::scheduleSteps(int64_t horizon)
+{
+    // Steps can be nudged early, so look ahead by the largest timing and groove offsets
+    const double lookahead = stepLengthInSamples * (maxTimingOffset + maxGrooveOffset);
+
+    while (nextStepTime - lookahead < (double)horizon)
+    {
+        scheduleStep(nextStepTime);
+        nextStepTime += stepLengthInSamples;
     }
 }
 
-void StepSequencerAudioProcessor::advanceStep()
+void StepSequencerAudioProcessor::scheduleStep(double stepTime)
 {
-    currentStep = (currentStep + 1) % NUM_STEPS;
-    updateFrequency();
+    // Evaluate the lanes once per step and turn them into timeline events
+    const auto &pattern = advanceStep(stepTime);
+    const int step = scheduledStep;
+    baseNote = chooseBaseNote();
+    updateStepNotes(pattern);
+
+    // Events can't be placed before the current sample
+    auto toSample = [this](double time)
+    { return juce::jmax(sampleClock, (int64_t)std::ceil(time)); };
+
+    TimelineEvent stepEvent;
+    stepEvent.time = toSample(stepTime);
+    stepEvent.type = TimelineEvent::Type::step;
+    stepEvent.step = step;
+    stepEvent.ccValue = pattern.cc[step];
+    timeline.add(stepEvent);
+
+    // Condition and probability are decided once per step. One value is always
+    // drawn so the random stream doesn't depend on the step settings.
+    const int condition = pattern.condition[step];
+    const bool chanceMet = random.nextFloat() < pattern.probability[step];
+    const bool plays = chanceMet && isTrigConditionMet(condition, patternLoop, fillActive, lastConditionMet);
+
+    if ((condition != 0 || pattern.probability[step] < 1.0f) && !isPreviousCondition(condition))
+        lastConditionMet = plays;
+
+    if (!plays)
+        return;
+
+    const int ratchets = pattern.ratchet[step];
+    const double ratchetLength = stepLengthInSamples / ratchets;
+    const double gateLength = ratchetLength * gateAmount * pattern.gate[step];
+    const double noteStart = stepTime + pattern.timing[step] * stepLengthInSamples + grooveTable.getOffset(stepClock);
+
+    TimelineEvent noteOn;
+    noteOn.type = TimelineEvent::Type::noteOn;
+    noteOn.step = step;
+    noteOn.frequency = getStepFrequency(pattern, step);
+    noteOn.velocity = pattern.velocity[step] * grooveTable.getVelocity(stepClock);
+    noteOn.glide = glideEnabled || pattern.slide[step] != 0;
+    noteOn.midiNote = getStepNote(pattern, step);
+
+    TimelineEvent noteOff;
+    noteOff.type = TimelineEvent::Type::noteOff;
+    noteOff.step = step;
+
+    for (int i = 0; i < ratchets; ++i)
+    {
+        const double onTime = noteStart + i * ratchetLength;
+        noteOn.time = toSample(onTime);
+        noteOn.noteId = noteOff.noteId = ++lastNoteId;
+        noteOff.time = toSample(onTime + gateLength);
+
+        timeline.add(noteOn);
+        timeline.add(noteOff);
+    }
+}
+
+void StepSequencerAudioProcessor::applyEvent(const TimelineEvent &event)
+{
+    const int samplePosition = (int)(sampleClock - blockStartClock);
+
+    switch (event.type)
+    {
+    case TimelineEvent::Type::step:
+        pushTelemetry(TelemetryEvent::Type::step, sampleClock, event.step);
+
+        if (midiOutputEnabled && midiCcNumber > 0)
+            outputMidi.addEvent(juce::MidiMessage::controllerEvent(1, midiCcNumber, event.ccValue), samplePosition);
+        break;
+
+    case TimelineEvent::Type::noteOn:
+        soundingNoteId = event.noteId;
+        gateIsOn = true;
+        pushTelemetry(TelemetryEvent::Type::gateOn, sampleClock, event.step, event.midiNote, event.velocity);
+        noteVelocity = event.velocity;
+        targetFrequency = event.frequency;
+
+        // If this note doesn't glide, snap immediately
+        if (!event.glide)
+            currentFrequency = targetFrequency;
+
+        if (midiOutputEnabled)
+        {
+            // Gliding notes overlap the previous one so the receiving synth
+            // plays them legato; a repeated pitch is still released first so
+            // the same note is never on twice
+            const int previousNote = midiNoteOut;
+            if (!event.glide || previousNote == event.midiNote)
+                emitMidiNoteOff(samplePosition);
+
+            outputMidi.addEvent(juce::MidiMessage::noteOn(1, event.midiNote, event.velocity), samplePosition);
+            midiNoteOut = event.midiNote;
+
+            if (event.glide && previousNote >= 0 && previousNote != event.midiNote)
+                outputMidi.addEvent(juce::MidiMessage::noteOff(1, previousNote), samplePosition);
+        }
+        break;
+
+    case TimelineEvent::Type::noteOff:
+        // A late note-off from an earlier note must not cut the current one
+        if (event.noteId == soundingNoteId)
+        {
+            gateIsOn = false;
+            pushTelemetry(TelemetryEvent::Type::gateOff, sampleClock, event.step);
+            emitMidiNoteOff(samplePosition);
+        }
+        break;
+    }
+}
+
+void StepSequencerAudioProcessor::pushTelemetry(TelemetryEvent::Type type, int64_t time, int step, int note, float velocity)
+{
+    TelemetryEvent event;
+    event.type = type;
+    event.time = time;
+    event.step = step;
+    event.note = note;
+    event.velocity = velocity;
+    telemetry.push(event);
+}
+
+void StepSequencerAudioProcessor::emitMidiNoteOff(int samplePosition)
+{
+    if (midiNoteOut < 0)
+        return;
+
+    outputMidi.addEvent(juce::MidiMessage::noteOff(1, midiNoteOut), samplePosition);
+    midiNoteOut = -1;
 }
 
 void StepSequencerAudioProcessor::resetSequencer()
 {
-    currentStep = -1;           // Start at -1 so first advance goes to step 0
-    samplesUntilNextStep = 0.0; // Trigger first step immediately
+    scheduledStep = -1; // Start at -1 so first advance goes to step 0
+    stepClock = -1;
+    patternLoop = -1;
+    lastConditionMet = true;
+    nextStepTime = (double)sampleClock; // Trigger first step immediately
+    timeline.clear();
+    gateIsOn = false;
+    mutator.rewind();
 }
 
-void StepSequencerAudioProcessor::updateFrequency()
+int StepSequencerAudioProcessor::chooseBaseNote()
 {
-    auto stepPitch = apvts.getRawParameterValue("step" + juce::String(currentStep))->load();
-    float midiNote = baseNote + stepPitch;
-    targetFrequency = 440.0f * std::pow(2.0f, (midiNote - 69.0f) / 12.0f);
+    if (heldNotes.isEmpty())
+        return baseNote;
 
-    // If glide is off, snap immediately
-    auto glideEnable = apvts.getRawParameterValue("glide_enable")->load() > 0.5f;
-    if (!glideEnable)
-        currentFrequency = targetFrequency;
+    if (arpMode == ArpMode::off)
+        return heldNotes.getNote(notePriority);
+
+    // The arpeggiator moves one held note per step; the step pitch is added on top
+    const float randomValue = arpMode == ArpMode::random ? random.nextFloat() : 0.0f;
+    return heldNotes.getArpNote(arpMode, stepClock, randomValue);
+}
+
+void StepSequencerAudioProcessor::updateStepNotes(const Pattern &pattern)
+{
+    if (scaleIndex < 0)
+        return;
+
+    if (stepNotesDirty)
+    {
+        stepNotesRows = 0;
+        stepNotesDirty = false;
+    }
+
+    // Bases a whole number of octaves apart share a row, so an arpeggio
+    // builds at most one row per pitch class it visits
+    const int pitchClass = getBasePitchClass();
+    if ((stepNotesRows >> pitchClass) & 1)
+        return;
+
+    auto &row = stepNotes[(size_t)pitchClass];
+    for (int i = 0; i < maxPatternSteps; ++i)
+    {
+        const int pitch = juce::roundToInt(pattern.pitch[i]);
+        row[(size_t)i] = (int8_t)(quantizeToScale(pitchClass + pitch, scaleIndex, 0) - pitchClass);
+    }
+
+    stepNotesRows = (uint16_t)(stepNotesRows | (1 << pitchClass));
+}
+
+int StepSequencerAudioProcessor::getStepNote(const Pattern &pattern, int step) const
+{
+    if (scaleIndex < 0)
+        return juce::jlimit(0, 127, juce::roundToInt(baseNote + pattern.pitch[step]));
+
+    return juce::jlimit(0, 127, baseNote + stepNotes[(size_t)getBasePitchClass()][(size_t)step]);
+}
+
+float StepSequencerAudioProcessor::getStepFrequency(const Pattern &pattern, int step) const
+{
+    // Quantized steps are whole notes and come straight from the tuning table;
+    // continuous pitches interpolate between its entries
+    const auto &tuning = tuningPublisher.getLive();
+    if (scaleIndex >= 0)
+        return tuning.frequencies[getStepNote(pattern, step)];
+
+    return tuning.getFrequency((float)baseNote + pattern.pitch[step]);
 }
 
 double StepSequencerAudioProcessor::calculateStepLength(double sampleRate, float rateMs)
@@ -288,24 +853,377 @@ double StepSequencerAudioProcessor::calculateStepLength(double sampleRate, float
     return seconds * sampleRate;
 }
 
+void StepSequencerAudioProcessor::applyRequestedPattern()
+{
+    if (requestedPattern < 0)
+        return;
+
+    activePattern = juce::jlimit(0, numBankPatterns - 1, requestedPattern);
+    requestedPattern = -1;
+    stepNotesDirty = true;
+    activePatternIndex.store(activePattern);
+}
+
+void StepSequencerAudioProcessor::setStepValue(StepLane lane, int step, float value)
+{
+    jassert(juce::isPositiveAndBelow(step, maxPatternSteps));
+    editPatterns[(size_t)selectedPattern].setValue(lane, step, value);
+    publishEditPattern(selectedPattern);
+}
+
+void StepSequencerAudioProcessor::modifyPattern(const std::function<void(Pattern &)> &edit)
+{
+    edit(editPatterns[(size_t)selectedPattern]);
+    publishEditPattern(selectedPattern);
+}
+
+void StepSequencerAudioProcessor::generateEuclidean(int hits, int steps, int rotation)
+{
+    // The rhythm comes from the precomputed table; the audio thread only
+    // sees the published snapshot. Hits play, rests get probability 0.
+    steps = juce::jlimit(1, maxPatternSteps, steps);
+    const auto &rhythm = getEuclideanRhythm(hits, steps);
+
+    modifyPattern([&rhythm, steps, rotation](Pattern &pattern)
+                  {
+        for (int i = 0; i < steps; ++i)
+        {
+            const int source = ((i - rotation) % steps + steps) % steps;
+            pattern.probability[i] = rhythm.isHit(source) ? 1.0f : 0.0f;
+        } });
+
+    if (auto *length = apvts.getParameter("length"))
+        length->setValueNotifyingHost(length->convertTo0to1((float)steps));
+}
+
+bool StepSequencerAudioProcessor::loadLibraryPattern(const PatternLibrary &library, int index)
+{
+    if (!juce::isPositiveAndBelow(index, library.getNumPatterns()))
+        return false;
+
+    modifyPattern([&library, index](Pattern &pattern)
+                  { library.readPattern(index, pattern); });
+
+    if (auto *length = apvts.getParameter("length"))
+        length->setValueNotifyingHost(length->convertTo0to1((float)library.getLength(index)));
+    return true;
+}
+
+bool StepSequencerAudioProcessor::saveBankToLibrary(const juce::File &file)
+{
+    std::vector<LibraryRecord> records((size_t)numBankPatterns);
+    for (int i = 0; i < numBankPatterns; ++i)
+    {
+        auto &record = records[(size_t)i];
+        record.name = file.getFileNameWithoutExtension() + " " + juce::String(i + 1);
+        record.length = getPatternLength();
+        record.pattern = editPatterns[(size_t)i];
+    }
+
+    return PatternLibrary::write(file, records);
+}
+
+void StepSequencerAudioProcessor::selectPattern(int index)
+{
+    selectedPattern = juce::jlimit(0, numBankPatterns - 1, index);
+    patternChanges.push(selectedPattern);
+
+    // Keep the host's "pattern" parameter on the selection. The audio thread
+    // takes the move as a request for the pattern just queued, so it switches once.
+    const float value = patternParameter->convertTo0to1((float)(selectedPattern + 1));
+    if (!juce::exactlyEqual(patternParameter->getValue(), value))
+        patternParameter->setValueNotifyingHost(value);
+
+    mutator.setSource(editPatterns[(size_t)selectedPattern], selectedPattern);
+    markStateChanged();
+}
+
+bool StepSequencerAudioProcessor::loadGroove(const juce::File &midiFile)
+{
+    juce::FileInputStream stream(midiFile);
+    juce::MidiFile file;
+    if (!stream.openedOk() || !file.readFrom(stream))
+        return false;
+
+    auto groove = GrooveTemplate::fromMidiFile(file);
+    if (groove.length == 0)
+        return false;
+
+    editGroove = groove;
+    groovePublisher.publish(editGroove);
+    markStateChanged();
+    return true;
+}
+
+void StepSequencerAudioProcessor::clearGroove()
+{
+    editGroove = {};
+    groovePublisher.publish(editGroove);
+    markStateChanged();
+}
+
+bool StepSequencerAudioProcessor::loadTuning(const juce::File &file)
+{
+    const auto text = file.loadFileAsString();
+
+    if (file.hasFileExtension("kbm"))
+    {
+        KeyboardMapping mapping;
+        if (!mapping.parse(text))
+            return false;
+
+        tuningMapping = mapping;
+        tuningMappingText = text;
+    }
+    else
+    {
+        ScalaScale scale;
+        if (!scale.parse(text))
+            return false;
+
+        tuningScale = scale;
+        tuningScaleText = text;
+    }
+
+    buildTuning();
+    return true;
+}
+
+void StepSequencerAudioProcessor::resetTuning()
+{
+    tuningScale = ScalaScale::twelveTone();
+    tuningMapping = {};
+    tuningScaleText.clear();
+    tuningMappingText.clear();
+    buildTuning();
+}
+
+void StepSequencerAudioProcessor::buildTuning()
+{
+    markStateChanged();
+    tuningBuilder.addJob([this, scale = tuningScale, mapping = tuningMapping]
+                         { tuningPublisher.publish(TuningTable::build(scale, mapping)); });
+}
+
+void StepSequencerAudioProcessor::publishEditPattern(int index)
+{
+    bank[(size_t)index].publish(editPatterns[(size_t)index]);
+    markStateChanged();
+
+    // Edits restart the mutation from the edited pattern
+    if (index == selectedPattern)
+        mutator.setSource(editPatterns[(size_t)index], index);
+}
+
 juce::AudioProcessorEditor *StepSequencerAudioProcessor::createEditor()
 {
     return new StepSequencerAudioProcessorEditor(*this);
 }
 
+// Step lanes of one pattern as a "Pattern" node, one space separated attribute per lane
+// Lanes missing from older states keep their defaults
+static Pattern patternFromValueTree(const juce::ValueTree &patternTree)
+{
+    Pattern pattern;
+    for (int lane = 0; lane < numStepLanes; ++lane)
+    {
+        auto values = juce::StringArray::fromTokens(patternTree[stepLanes[lane].id].toString(), " ", {});
+        for (int i = 0; i < juce::jmin(values.size(), maxPatternSteps); ++i)
+            pattern.setValue((StepLane)lane, i, values[i].getFloatValue());
+    }
+    return pattern;
+}
+
+// Migrates the XML state written by earlier versions
+static void stateFromXml(const juce::XmlElement &xml, PluginState &loaded)
+{
+    auto state = juce::ValueTree::fromXml(xml);
+
+    if (auto bankTree = state.getChildWithName("Bank"); bankTree.isValid())
+    {
+        loaded.selectedPattern = juce::jlimit(0, numBankPatterns - 1, (int)bankTree["selected"]);
+        for (const auto &patternTree : bankTree)
+        {
+            int index = patternTree["index"];
+            if (juce::isPositiveAndBelow(index, numBankPatterns))
+                loaded.patterns[(size_t)index] = patternFromValueTree(patternTree);
+        }
+        state.removeChild(bankTree, nullptr);
+    }
+    else if (auto patternTree = state.getChildWithName("Pattern"); patternTree.isValid())
+    {
+        // Single pattern sessions from before the bank existed
+        loaded.patterns[0] = patternFromValueTree(patternTree);
+        state.removeChild(patternTree, nullptr);
+    }
+    else
+    {
+        // Sessions saved before patterns moved out of the parameters kept
+        // one "stepN" parameter per step for an 8 step pattern
+        for (int i = 0; i < defaultPatternLength; ++i)
+        {
+            auto param = state.getChildWithProperty("id", "step" + juce::String(i));
+            if (param.isValid())
+                loaded.patterns[0].setValue(StepLane::pitch, i, (float)param["value"]);
+        }
+    }
+
+    if (auto grooveTree = state.getChildWithName("Groove"); grooveTree.isValid())
+    {
+        auto timing = juce::StringArray::fromTokens(grooveTree["timing"].toString(), " ", {});
+        auto velocity = juce::StringArray::fromTokens(grooveTree["velocity"].toString(), " ", {});
+
+        loaded.groove.length = juce::jmin(timing.size(), velocity.size(), maxGrooveSteps);
+        for (int i = 0; i < loaded.groove.length; ++i)
+        {
+            loaded.groove.timing[i] = juce::jlimit(-maxGrooveOffset, maxGrooveOffset, timing[i].getFloatValue());
+            loaded.groove.velocity[i] = juce::jlimit(0.0f, 1.0f, velocity[i].getFloatValue());
+        }
+        state.removeChild(grooveTree, nullptr);
+    }
+
+    if (auto tuningTree = state.getChildWithName("Tuning"); tuningTree.isValid())
+    {
+        loaded.tuningScale = tuningTree["scale"].toString();
+        loaded.tuningMapping = tuningTree["mapping"].toString();
+        state.removeChild(tuningTree, nullptr);
+    }
+
+    loaded.parameters = state;
+}
+
+std::shared_ptr<const PluginState> StepSequencerAudioProcessor::captureState()
+{
+    // Message thread (or the constructor): the edit-side state belongs to it
+    auto state = std::make_shared<PluginState>();
+    state->parameters = apvts.copyState();
+    state->patterns = editPatterns;
+    state->selectedPattern = selectedPattern;
+    state->groove = editGroove;
+    state->tuningScale = tuningScaleText;
+    state->tuningMapping = tuningMappingText;
+
+    const juce::ScopedLock lock(stateLock);
+    capturedState = state;
+    return state;
+}
+
+void StepSequencerAudioProcessor::storeState(const juce::MemoryBlock &blob, uint32_t generation)
+{
+    // A slow write must not replace a newer blob
+    const juce::ScopedLock lock(stateLock);
+    if (generation > cachedStateGeneration)
+    {
+        cachedState = blob;
+        cachedStateGeneration = generation;
+    }
+}
+
+void StepSequencerAudioProcessor::parameterValueChanged(int parameterIndex, float)
+{
+    // Any thread, including the audio thread
+    if (parameterIndex == swingParameter->getParameterIndex())
+        swingChanged = true;
+
+    markStateChanged();
+}
+
+void StepSequencerAudioProcessor::timerCallback()
+{
+    // Snapshot the state on the message thread, serialize it in the background
+    const auto generation = stateGeneration.load();
+    if (generation == queuedStateGeneration)
+        return;
+    queuedStateGeneration = generation;
+
+    auto state = captureState();
+    stateWriter.addJob([this, state, generation]
+                       {
+                           juce::MemoryBlock blob;
+                           StateFormat::write(*state, blob);
+                           storeState(blob, generation); });
+}
+
 void StepSequencerAudioProcessor::getStateInformation(juce::MemoryBlock &destData)
 {
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
-    copyXmlToBinary(*xml, destData);
+    // The generation is read first, so a change racing with the capture below
+    // only makes the stored blob newer than its label, never older
+    const auto generation = stateGeneration.load();
+    {
+        const juce::ScopedLock lock(stateLock);
+        if (cachedStateGeneration == generation)
+        {
+            destData = cachedState;
+            return;
+        }
+    }
+
+    if (juce::MessageManager::existsAndIsCurrentThread())
+    {
+        StateFormat::write(*captureState(), destData);
+        storeState(destData, generation);
+        return;
+    }
+
+    // On any other thread the edit-side state can't be read. Save the last
+    // snapshot the message thread took, with the parameters copied now
+    // (copyState is thread safe). It may miss the newest edits, so it isn't
+    // cached.
+    auto state = std::make_unique<PluginState>();
+    {
+        const juce::ScopedLock lock(stateLock);
+        if (capturedState != nullptr)
+            *state = *capturedState;
+    }
+    state->parameters = apvts.copyState();
+    StateFormat::write(*state, destData);
 }
 
 void StepSequencerAudioProcessor::setStateInformation(const void *data, int sizeInBytes)
 {
-    std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
-    if (xmlState.get() != nullptr)
-        if (xmlState->hasTagName(apvts.state.getType()))
-            apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+    auto loaded = std::make_unique<PluginState>();
+
+    if (StateFormat::isBinaryState(data, sizeInBytes))
+    {
+        if (!StateFormat::read(data, sizeInBytes, *loaded))
+            return;
+    }
+    else
+    {
+        std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
+        if (xmlState.get() == nullptr)
+            return;
+        stateFromXml(*xmlState, *loaded);
+    }
+
+    if (!loaded->parameters.hasType(apvts.state.getType()))
+        return;
+
+    ScalaScale loadedScale = ScalaScale::twelveTone();
+    KeyboardMapping loadedMapping;
+    juce::String loadedScaleText, loadedMappingText;
+    if (loadedScale.parse(loaded->tuningScale))
+        loadedScaleText = loaded->tuningScale;
+    if (loadedMapping.parse(loaded->tuningMapping))
+        loadedMappingText = loaded->tuningMapping;
+
+    apvts.replaceState(loaded->parameters);
+
+    tuningScale = loadedScale;
+    tuningMapping = loadedMapping;
+    tuningScaleText = loadedScaleText;
+    tuningMappingText = loadedMappingText;
+    buildTuning();
+
+    editGroove = loaded->groove;
+    groovePublisher.publish(editGroove);
+
+    editPatterns = loaded->patterns;
+    for (int i = 0; i < numBankPatterns; ++i)
+        publishEditPattern(i);
+
+    selectPattern(loaded->selectedPattern);
+    ++patternVersion;
 }
 
 juce::AudioProcessor *JUCE_CALLTYPE createPluginFilter()
@@ -1,8 +1,26 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "ControlRate.h"
+#include "StepPattern.h"
+#include "PatternBank.h"
+#include "BlockTimeline.h"
+#include "Groove.h"
+#include "Arpeggiator.h"
+#include "FastRandom.h"
+#include "PatternMutator.h"
+#include "Scale.h"
+#include "Tuning.h"
+#include "TelemetryRing.h"
+#include "AnalyzerFifo.h"
+#include "LoadMeter.h"
+#include "Tracing.h"
+#include "StateFormat.h"
+#include "PatternLibrary.h"
 
-class StepSequencerAudioProcessor : public juce::AudioProcessor
+class StepSequencerAudioProcessor : public juce::AudioProcessor,
+                                    private juce::AudioProcessorParameter::Listener,
+                                    private juce::Timer
 {
 public:
     StepSequencerAudioProcessor();
@@ -18,8 +36,8 @@ public:
 
     const juce::String getName() const override { return JucePlugin_Name; }
     bool acceptsMidi() const override { return true; }
-    bool producesMidi() const override { return false; }
-    bool isMidiEffect() const override { return false; }
+    bool producesMidi() const override { return true; }
+    bool isMidiEffect() const override { return JucePlugin_IsMidiEffect; }
     double getTailLengthSeconds() const override { return 0.0; }
 
     int getNumPrograms() override { return 1; }
@@ -33,37 +51,247 @@ public:
 
     juce::AudioProcessorValueTreeState &getValueTreeState() { return apvts; }
 
-    // Get current step for UI
-    int getCurrentStep() const { return currentStep; }
-    bool getIsPlaying() const { return isNoteOn; }
+    // Playback events for the UI (message thread, single consumer)
+    bool hasTelemetry() const { return telemetry.hasPending(); }
+    bool popTelemetry(TelemetryEvent &event) { return telemetry.pop(event); }
 
-private:
-    static constexpr int NUM_STEPS = 8;
+#if !JucePlugin_IsMidiEffect
+    // Decimated output samples for the editor's scope and spectrum; only
+    // filled while an editor has it switched on
+    AnalyzerFifo &getAnalyzer() { return analyzer; }
+#endif
+
+    // Time spent in processBlock as a fraction of each block's real-time budget
+    const LoadMeter &getLoadMeter() const { return loadMeter; }
+
+    // Pattern editing (message thread). Edits apply to the selected bank
+    // pattern; each one publishes a new snapshot that the audio thread picks
+    // up at its next step.
+    int getPatternLength() const { return (int)lengthValue->load(); }
+    float getStepValue(StepLane lane, int step) const { return editPatterns[(size_t)selectedPattern].getValue(lane, step); }
+    void setStepValue(StepLane lane, int step, float value);
+    const Pattern &getEditPattern() const { return editPatterns[(size_t)selectedPattern]; }
+
+    // Applies a bulk edit (randomize, shift, paste...) and publishes it as one snapshot
+    void modifyPattern(const std::function<void(Pattern &)> &edit);
+
+    // Fills the probability lane with the Euclidean rhythm E(hits, steps),
+    // rotated by 'rotation' steps, and sets the pattern length to 'steps'
+    void generateEuclidean(int hits, int steps, int rotation);
+
+    // Pattern library files (message thread). Loading copies one mapped
+    // record into the selected pattern and publishes it as a new snapshot;
+    // saving writes every bank pattern at the current length.
+    bool loadLibraryPattern(const PatternLibrary &library, int index);
+    bool saveBankToLibrary(const juce::File &file);
+
+    // Selects the bank pattern to edit and queues a switch to it, applied at
+    // the next boundary set by the "switch_quantize" parameter. The "pattern"
+    // parameter is moved along so the host sees the selection.
+    void selectPattern(int index);
+    int getSelectedPattern() const { return selectedPattern; }
+
+    // The bank pattern the audio thread is playing
+    int getActivePattern() const { return activePatternIndex.load(); }
+
+    // Groove templates (message thread). Imported grooves are compiled with
+    // the swing amount into a per-step offset table on the audio thread.
+    bool loadGroove(const juce::File &midiFile);
+    void clearGroove();
+    bool hasGroove() const { return editGroove.length > 0; }
 
+    // Microtuning (message thread). A Scala scale (.scl) or keyboard mapping
+    // (.kbm) replaces that half of the tuning; the frequency table is rebuilt
+    // in the background and swapped in at the next block.
+    bool loadTuning(const juce::File &file);
+    void resetTuning();
+    bool hasTuning() const { return tuningScaleText.isNotEmpty() || tuningMappingText.isNotEmpty(); }
+    juce::String getTuningName() const { return tuningScale.description; }
+
+    // Bumped whenever patterns are replaced wholesale (e.g. state load) so the editor can refresh
+    int getPatternVersion() const { return patternVersion.load(); }
+
+private:
     juce::AudioProcessorValueTreeState apvts;
+    std::atomic<float> *lengthValue = nullptr; // read by the editor every frame
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
     // Synth state
-    bool isNoteOn = false;
-    int baseNote = 60;
+    bool isNoteOn = false; // true while any key is held
+    int baseNote = 60;     // chosen from the held keys at each step
     float phase = 0.0f;
     float currentFrequency = 440.0f;
     float targetFrequency = 440.0f;
     float glideRate = 0.0f;
+    bool glideEnabled = false;
+    int controlQuantum = controlQuantumSizes[defaultControlQuantumIndex];
 
     // Sequencer state
-    int currentStep = 0;
-    double samplesUntilNextStep = 0.0;
+    int scheduledStep = 0; // last step turned into timeline events
     double stepLengthInSamples = 0.0;
-    double gateOffSamples = 0.0;
+    float gateAmount = 0.5f;
     bool gateIsOn = false;
+    float noteVelocity = 1.0f;
+
+    // Generative decisions (probability, conditions, random arp) all draw from
+    // 'random', reseeded from the seed and the loop count at every pattern
+    // loop, so a given seed and position always play the same way
+    FastRandom random;
+    uint32_t randomSeed = 1;
+    int64_t patternLoop = -1; // pattern loops since the sequencer was restarted
+    bool fillActive = false;
+    bool lastConditionMet = true;
+
+    // Held keys and how they pick the base note, read once per block
+    HeldNotes heldNotes;
+    ArpMode arpMode = ArpMode::off;
+    NotePriority notePriority = NotePriority::last;
+
+    // Event timeline, in absolute samples since playback was prepared
+    BlockTimeline timeline;
+    int64_t sampleClock = 0;
+    double nextStepTime = 0.0;
+    uint32_t lastNoteId = 0;
+    uint32_t soundingNoteId = 0;
+
+    // Pattern storage: the message thread edits 'editPatterns' and publishes
+    // immutable copies into the bank; the audio thread plays the live
+    // snapshot of the active bank slot
+    std::array<Pattern, numBankPatterns> editPatterns;
+    int selectedPattern = 0;
+    PatternBank bank;
+    std::atomic<int> patternVersion{0};
+    int patternLength = defaultPatternLength;
+
+    void publishEditPattern(int index);
+
+    // Scale quantizer: the playing pattern's step pitches, snapped to the
+    // scale, are cached per step as offsets from the base note. Snapping only
+    // depends on the base note's pitch class relative to the key, so there is
+    // one row per pitch class, built the first time it plays and dropped when
+    // the pattern or scale changes. Notes then index the tuning table.
+    int scaleIndex = -1; // -1 = off, pitches stay continuous
+    int scaleKey = 0;
+    std::array<std::array<int8_t, maxPatternSteps>, 12> stepNotes{};
+    uint16_t stepNotesRows = 0; // bit per pitch class row already built
+    bool stepNotesDirty = true;
+
+    int getBasePitchClass() const { return ((baseNote - scaleKey) % 12 + 12) % 12; }
+
+    void updateStepNotes(const Pattern &pattern);
+    int getStepNote(const Pattern &pattern, int step) const;
+
+    // Tuning: the Scala sources as loaded (message thread) and the table the
+    // audio thread reads. Tables are built on 'tuningBuilder', the only thread
+    // that publishes them.
+    juce::String tuningScaleText, tuningMappingText;
+    ScalaScale tuningScale = ScalaScale::twelveTone();
+    KeyboardMapping tuningMapping;
+    SnapshotPublisher<TuningTable> tuningPublisher;
+    juce::ThreadPool tuningBuilder{juce::ThreadPoolOptions().withThreadName("Tuning Builder").withNumberOfThreads(1)};
+
+    void buildTuning();
+
+    // Optional generative mutation of the selected pattern, evolved on a
+    // background thread and picked up at bar boundaries
+    PatternMutator mutator{apvts};
+    bool mutationEnabled = false;
+
+    // Pattern switching (audio thread)
+    PatternChangeQueue patternChanges;
+    int activePattern = 0;
+    int requestedPattern = -1; // -1 when no change is pending
+    int lastPatternParam = -1;
+    juce::RangedAudioParameter *patternParameter = nullptr;
+    std::atomic<float> *patternValue = nullptr;
+    std::atomic<float> *switchQuantizeValue = nullptr;
+    int64_t stepClock = -1; // steps since the sequencer was restarted
+    std::atomic<int> activePatternIndex{0};
+
+    void applyRequestedPattern();
+
+    // Groove: 'editGroove' is the message thread copy, 'grooveTable' the compiled audio thread table
+    GrooveTemplate editGroove;
+    SnapshotPublisher<GrooveTemplate> groovePublisher;
+    GrooveTable grooveTable;
+    juce::RangedAudioParameter *swingParameter = nullptr;
+    std::atomic<bool> swingChanged{true}; // set by the parameter listener, cleared on recompile
+
+    // MIDI output: events are written sample-accurately into a buffer
+    // reserved in prepareToPlay, then copied into the host's buffer
+    juce::MidiBuffer outputMidi;
+    bool midiOutputEnabled = false;
+    int midiCcNumber = 0; // 0 = no CC per step
+    int midiNoteOut = -1; // note currently held on the MIDI output
+    int64_t blockStartClock = 0;
+
+    void emitMidiNoteOff(int samplePosition);
+
+    // Step, gate and voice events for the editor
+    TelemetryRing telemetry;
+    void pushTelemetry(TelemetryEvent::Type type, int64_t time, int step = 0, int note = 0, float velocity = 0.0f);
+
+#if !JucePlugin_IsMidiEffect
+    AnalyzerFifo analyzer;
+#endif
+
+    LoadMeter loadMeter;
+
+    // Saved state cache. 'stateGeneration' is bumped by every parameter,
+    // pattern, groove or tuning change; while it matches the cached blob's
+    // generation, getStateInformation only copies bytes. A timer snapshots
+    // changed state on the message thread and serializes it on 'stateWriter'
+    // ahead of the host. Hosts saving from another thread get the latest
+    // snapshot, since only the message thread may read the edit-side state.
+    std::atomic<uint32_t> stateGeneration{1};
+    uint32_t queuedStateGeneration = 0; // message thread
+    juce::CriticalSection stateLock;
+    juce::MemoryBlock cachedState;      // guarded by stateLock
+    uint32_t cachedStateGeneration = 0; // guarded by stateLock
+    std::shared_ptr<const PluginState> capturedState; // guarded by stateLock
+    juce::ThreadPool stateWriter{juce::ThreadPoolOptions().withThreadName("State Writer").withNumberOfThreads(1)};
+
+    void markStateChanged() { ++stateGeneration; }
+    std::shared_ptr<const PluginState> captureState();
+    void storeState(const juce::MemoryBlock &blob, uint32_t generation);
+    void timerCallback() override;
+    void parameterValueChanged(int parameterIndex, float) override;
+    void parameterGestureChanged(int, bool) override {}
+
+#if STEP_SEQUENCER_TRACING
+    // Writes the trace file while any instance is alive
+    juce::SharedResourcePointer<TraceWriter> traceWriter;
+#endif
 
     // Tempo sync
     juce::AudioPlayHead::PositionInfo lastPosInfo;
 
-    void advanceStep();
+    // Beat and bar grid, updated each block from the host's time signature.
+    // While the host plays, 'hostGrid' is set and steps are placed in its bars
+    // by their position in quarter notes.
+    int stepsPerBeat = 4;
+    int stepsPerBar = 16;
+    bool hostGrid = false;
+    double blockStartPpq = 0.0;
+    double barStartPpq = 0.0;
+    double ppqPerSample = 0.0;
+    double beatLengthPpq = 1.0;
+    double barLengthPpq = 4.0;
+
+    void updateBarGrid(bool hasPosition, double sampleRate);
+    StepPosition getStepPosition(double stepTime) const;
+
+    const Pattern &advanceStep(double stepTime);
+    void scheduleSteps(int64_t horizon);
+    void scheduleStep(double stepTime);
+    void applyEvent(const TimelineEvent &event);
     void resetSequencer();
-    void updateFrequency();
+    int chooseBaseNote();
+    float getStepFrequency(const Pattern &pattern, int step) const;
+#if !JucePlugin_IsMidiEffect
+    void renderSegment(float *output, int numSamples);
+    void advanceGlide(int numSamples);
+#endif
     double calculateStepLength(double sampleRate, float rateParam);
 
     std::atomic<float> currentBpm{120.0f}; // Default to 120 BPM
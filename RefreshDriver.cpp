@@ -0,0 +1,61 @@
+#include "RefreshDriver.h"
+
+void RefreshDriver::addClient(Client &client, juce::Component &component)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    clients.push_back({&client, &component});
+    updateAttachment();
+}
+
+void RefreshDriver::removeClient(Client &client)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                 [&client](const Registration &r)
+                                 { return r.client == &client; }),
+                  clients.end());
+    updateAttachment();
+}
+
+void RefreshDriver::clientVisibilityChanged()
+{
+    updateAttachment();
+}
+
+void RefreshDriver::tick()
+{
+    // Index loop: a refresh may close an editor and unregister it
+    for (size_t i = 0; i < clients.size(); ++i)
+        if (clients[i].component->isShowing())
+            clients[i].client->refresh();
+}
+
+void RefreshDriver::updateAttachment()
+{
+    // Keep the current attachment while its component is still on screen
+    juce::Component *target = nullptr;
+    for (const auto &registration : clients)
+    {
+        if (!registration.component->isShowing())
+            continue;
+
+        if (registration.component == attachedTo)
+        {
+            target = attachedTo;
+            break;
+        }
+
+        if (target == nullptr)
+            target = registration.component;
+    }
+
+    if (target == attachedTo)
+        return;
+
+    attachment.reset();
+    attachedTo = target;
+
+    if (target != nullptr)
+        attachment = std::make_unique<juce::VBlankAttachment>(target, [this]
+                                                              { tick(); });
+}
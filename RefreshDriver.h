@@ -0,0 +1,46 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// One process-wide UI refresh tick shared by every open editor, synced to the
+// display's vertical blank. The driver attaches to a single showing editor;
+// each vblank it refreshes all showing clients in one pass. With no editor on
+// screen there is no attachment at all, so nothing runs.
+//
+// Use through juce::SharedResourcePointer<RefreshDriver>.
+class RefreshDriver
+{
+public:
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+        // Called once per frame while the client's component is showing
+        virtual void refresh() = 0;
+    };
+
+    RefreshDriver() = default;
+
+    void addClient(Client &client, juce::Component &component);
+    void removeClient(Client &client);
+
+    // Call when a client's component was shown, hidden or moved to another window
+    void clientVisibilityChanged();
+
+private:
+    struct Registration
+    {
+        Client *client;
+        juce::Component *component;
+    };
+
+    void tick();
+    void updateAttachment();
+
+    std::vector<Registration> clients;
+    juce::Component *attachedTo = nullptr;
+    std::unique_ptr<juce::VBlankAttachment> attachment;
+
+    JUCE_DECLARE_NON_COPYABLE(RefreshDriver)
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Scale masks: bit n is set when the note n semitones above the key root is in the scale
+constexpr uint16_t makeScaleMask(std::initializer_list<int> degrees)
+{
+    uint16_t mask = 0;
+    for (auto degree : degrees)
+        mask = (uint16_t)(mask | (1 << degree));
+    return mask;
+}
+
+struct ScaleInfo
+{
+    const char *name;
+    uint16_t mask;
+};
+
+static constexpr ScaleInfo scales[] = {
+    {"Chromatic", makeScaleMask({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11})},
+    {"Major", makeScaleMask({0, 2, 4, 5, 7, 9, 11})},
+    {"Minor", makeScaleMask({0, 2, 3, 5, 7, 8, 10})},
+    {"Dorian", makeScaleMask({0, 2, 3, 5, 7, 9, 10})},
+    {"Phrygian", makeScaleMask({0, 1, 3, 5, 7, 8, 10})},
+    {"Lydian", makeScaleMask({0, 2, 4, 6, 7, 9, 11})},
+    {"Mixolydian", makeScaleMask({0, 2, 4, 5, 7, 9, 10})},
+    {"Locrian", makeScaleMask({0, 1, 3, 5, 6, 8, 10})},
+    {"Harmonic Minor", makeScaleMask({0, 2, 3, 5, 7, 8, 11})},
+    {"Melodic Minor", makeScaleMask({0, 2, 3, 5, 7, 9, 11})},
+    {"Major Pentatonic", makeScaleMask({0, 2, 4, 7, 9})},
+    {"Minor Pentatonic", makeScaleMask({0, 3, 5, 7, 10})},
+    {"Blues", makeScaleMask({0, 3, 5, 6, 7, 10})},
+    {"Whole Tone", makeScaleMask({0, 2, 4, 6, 8, 10})}};
+
+static constexpr int numScales = (int)std::size(scales);
+
+// For every scale and pitch class (relative to the key root), the offset in
+// semitones to the nearest note of the scale. Ties snap down.
+struct ScaleSnapTable
+{
+    int8_t offset[numScales][12];
+};
+
+constexpr ScaleSnapTable makeScaleSnapTable()
+{
+    ScaleSnapTable table{};
+    for (int scale = 0; scale < numScales; ++scale)
+    {
+        const uint16_t mask = scales[scale].mask;
+        for (int pitchClass = 0; pitchClass < 12; ++pitchClass)
+        {
+            for (int distance = 0; distance <= 6; ++distance)
+            {
+                if ((mask >> ((pitchClass - distance + 12) % 12)) & 1)
+                {
+                    table.offset[scale][pitchClass] = (int8_t)-distance;
+                    break;
+                }
+                if ((mask >> ((pitchClass + distance) % 12)) & 1)
+                {
+                    table.offset[scale][pitchClass] = (int8_t)distance;
+                    break;
+                }
+            }
+        }
+    }
+    return table;
+}
+
+inline constexpr ScaleSnapTable scaleSnapTable = makeScaleSnapTable();
+
+static_assert(scaleSnapTable.offset[1][6] == -1, "F# snaps down to F in C major");
+static_assert(scaleSnapTable.offset[10][5] == -1, "F snaps down to E in C major pentatonic");
+
+// Moves a MIDI note onto the nearest note of the scale in the given key (0 = C)
+inline int quantizeToScale(int note, int scale, int key)
+{
+    const int pitchClass = ((note - key) % 12 + 12) % 12;
+    return note + scaleSnapTable.offset[scale][pitchClass];
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// An immutable, published copy of some engine data (a pattern, a groove...).
+// Snapshots are built on the message thread, handed to the audio thread with
+// an atomic pointer swap and freed back on the message thread once the audio
+// thread has let go of them.
+template <typename ValueType>
+struct Snapshot
+{
+    ValueType value;
+
+    // Intrusive link used while the snapshot waits to be reclaimed
+    Snapshot *nextRetired = nullptr;
+};
+
+// RCU-style handover of snapshots from one writer thread (message thread) to
+// the audio thread. The audio thread never allocates, frees or blocks: it
+// swaps pointers and pushes the snapshot it stops using onto a retired list
+// that the writer drains.
+template <typename ValueType>
+class SnapshotPublisher
+{
+public:
+    using SnapshotType = Snapshot<ValueType>;
+
+    SnapshotPublisher()
+        : live(new SnapshotType())
+    {
+    }
+
+    ~SnapshotPublisher()
+    {
+        // Both threads are done by now
+        reclaim();
+        delete pending.exchange(nullptr);
+        delete live;
+    }
+
+    // Writer thread: make a new snapshot the next one the audio thread picks up.
+    // A snapshot that was published but never picked up is simply replaced.
+    void publish(std::unique_ptr<SnapshotType> snapshot)
+    {
+        reclaim();
+        delete pending.exchange(snapshot.release());
+    }
+
+    // Writer thread: copies the value into a new snapshot and publishes it
+    void publish(const ValueType &value)
+    {
+        auto snapshot = std::make_unique<SnapshotType>();
+        snapshot->value = value;
+        publish(std::move(snapshot));
+    }
+
+    // Writer thread: free snapshots the audio thread has finished with
+    void reclaim()
+    {
+        auto *snapshot = retired.exchange(nullptr);
+        while (snapshot != nullptr)
+        {
+            auto *next = snapshot->nextRetired;
+            delete snapshot;
+            snapshot = next;
+        }
+    }
+
+    // Audio thread: switch to the newest published snapshot, if any. Call this
+    // only at points where a change is allowed (e.g. step or bar boundaries).
+    // Returns true if the value changed.
+    bool acquire()
+    {
+        auto *next = pending.exchange(nullptr);
+        if (next == nullptr)
+            return false;
+
+        retire(live);
+        live = next;
+        return true;
+    }
+
+    // Audio thread: the snapshot currently in use
+    const ValueType &getLive() const { return live->value; }
+
+private:
+    void retire(SnapshotType *snapshot)
+    {
+        // Single pusher (audio thread), single consumer taking the whole list,
+        // so this loop only retries while reclaim() swaps the head
+        snapshot->nextRetired = retired.load();
+        while (!retired.compare_exchange_weak(snapshot->nextRetired, snapshot))
+        {
+        }
+    }
+
+    SnapshotType *live;                         // owned by the audio thread
+    std::atomic<SnapshotType *> pending{nullptr}; // published, not yet picked up
+    std::atomic<SnapshotType *> retired{nullptr}; // released by the audio thread
+
+    JUCE_DECLARE_NON_COPYABLE(SnapshotPublisher)
+};
@@ -0,0 +1,238 @@
+#include "StateFormat.h"
+
+static const int stateMagic = (int)juce::ByteOrder::littleEndianInt("S8SQ");
+static const int parametersTag = (int)juce::ByteOrder::littleEndianInt("PARM");
+static const int bankTag = (int)juce::ByteOrder::littleEndianInt("BANK");
+static const int grooveTag = (int)juce::ByteOrder::littleEndianInt("GROV");
+static const int tuningTag = (int)juce::ByteOrder::littleEndianInt("TUNE");
+
+// Lanes holding small whole numbers are stored as one byte per step
+static bool isByteLane(const StepLaneInfo &info)
+{
+    return info.interval >= 1.0f && info.minValue >= 0.0f && info.maxValue <= 255.0f;
+}
+
+// Bitwise, so a value that differs from the default in any way is kept
+static bool isDefaultValue(float value, float defaultValue)
+{
+    return std::memcmp(&value, &defaultValue, sizeof(float)) == 0;
+}
+
+static void writeSection(juce::OutputStream &stream, int tag, const juce::MemoryOutputStream &section)
+{
+    stream.writeInt(tag);
+    stream.writeInt((int)section.getDataSize());
+    stream.write(section.getData(), section.getDataSize());
+}
+
+bool StateFormat::isBinaryState(const void *data, int sizeInBytes)
+{
+    return sizeInBytes >= 8 && (int)juce::ByteOrder::littleEndianInt(data) == stateMagic;
+}
+
+void StateFormat::write(const PluginState &state, juce::MemoryBlock &destData)
+{
+    juce::MemoryOutputStream stream(destData, false);
+    stream.writeInt(stateMagic);
+    stream.writeInt(version);
+
+    {
+        juce::MemoryOutputStream section;
+        state.parameters.writeToStream(section);
+        writeSection(stream, parametersTag, section);
+    }
+
+    {
+        // The record lengths come first so a reader can find any pattern
+        // without decoding the ones before it
+        juce::MemoryOutputStream records;
+        juce::MemoryOutputStream section;
+        section.writeInt(state.selectedPattern);
+        section.writeInt(numBankPatterns);
+        section.writeInt(maxPatternSteps);
+
+        for (const auto &pattern : state.patterns)
+        {
+            const auto start = records.getPosition();
+            writePattern(records, pattern);
+            section.writeInt((int)(records.getPosition() - start));
+        }
+
+        section.write(records.getData(), records.getDataSize());
+        writeSection(stream, bankTag, section);
+    }
+
+    if (state.groove.length > 0)
+    {
+        juce::MemoryOutputStream section;
+        section.writeInt(state.groove.length);
+        for (int i = 0; i < state.groove.length; ++i)
+        {
+            section.writeFloat(state.groove.timing[i]);
+            section.writeFloat(state.groove.velocity[i]);
+        }
+        writeSection(stream, grooveTag, section);
+    }
+
+    if (state.tuningScale.isNotEmpty() || state.tuningMapping.isNotEmpty())
+    {
+        juce::MemoryOutputStream section;
+        section.writeString(state.tuningScale);
+        section.writeString(state.tuningMapping);
+        writeSection(stream, tuningTag, section);
+    }
+}
+
+void StateFormat::writePattern(juce::OutputStream &stream, const Pattern &pattern)
+{
+    // Untouched patterns are written as empty records
+    juce::Array<int> changedLanes;
+    for (int lane = 0; lane < numStepLanes; ++lane)
+    {
+        for (int i = 0; i < maxPatternSteps; ++i)
+        {
+            if (!isDefaultValue(pattern.getValue((StepLane)lane, i), stepLanes[lane].defaultValue))
+            {
+                changedLanes.add(lane);
+                break;
+            }
+        }
+    }
+
+    if (changedLanes.isEmpty())
+        return;
+
+    // Each lane: its id, the bytes per value, then one value per step
+    stream.writeByte((char)changedLanes.size());
+    for (int lane : changedLanes)
+    {
+        const auto &info = stepLanes[lane];
+        const bool bytes = isByteLane(info);
+
+        stream.writeString(info.id);
+        stream.writeByte(bytes ? 1 : 4);
+        for (int i = 0; i < maxPatternSteps; ++i)
+        {
+            const float value = pattern.getValue((StepLane)lane, i);
+            if (bytes)
+                stream.writeByte((char)juce::roundToInt(value));
+            else
+                stream.writeFloat(value);
+        }
+    }
+}
+
+bool StateFormat::read(const void *data, int sizeInBytes, PluginState &state)
+{
+    if (!isBinaryState(data, sizeInBytes))
+        return false;
+
+    juce::MemoryInputStream stream(data, (size_t)sizeInBytes, false);
+    stream.readInt(); // magic
+
+    // Newer versions only add sections, which are skipped below
+    if (stream.readInt() < 1)
+        return false;
+
+    bool hasParameters = false;
+    while (stream.getNumBytesRemaining() >= 8)
+    {
+        const int tag = stream.readInt();
+        const int length = stream.readInt();
+        if (length < 0 || length > stream.getNumBytesRemaining())
+            return false;
+
+        juce::MemoryInputStream section(static_cast<const char *>(data) + stream.getPosition(), (size_t)length, false);
+        stream.skipNextBytes(length);
+
+        if (tag == parametersTag)
+        {
+            state.parameters = juce::ValueTree::readFromStream(section);
+            hasParameters = state.parameters.isValid();
+        }
+        else if (tag == bankTag)
+        {
+            if (!readBank(section, state))
+                return false;
+        }
+        else if (tag == grooveTag)
+        {
+            state.groove.length = juce::jlimit(0, maxGrooveSteps, section.readInt());
+            for (int i = 0; i < state.groove.length; ++i)
+            {
+                const float timing = section.readFloat();
+                const float velocity = section.readFloat();
+                state.groove.timing[i] = std::isfinite(timing) ? juce::jlimit(-maxGrooveOffset, maxGrooveOffset, timing) : 0.0f;
+                state.groove.velocity[i] = std::isfinite(velocity) ? juce::jlimit(0.0f, 1.0f, velocity) : 1.0f;
+            }
+        }
+        else if (tag == tuningTag)
+        {
+            state.tuningScale = section.readString();
+            state.tuningMapping = section.readString();
+        }
+    }
+
+    return hasParameters;
+}
+
+bool StateFormat::readBank(juce::MemoryInputStream &stream, PluginState &state)
+{
+    state.selectedPattern = juce::jlimit(0, numBankPatterns - 1, stream.readInt());
+    const int numPatterns = stream.readInt();
+    const int numSteps = stream.readInt();
+    if (numPatterns < 0 || numSteps < 0 || (int64_t)numPatterns * 4 > stream.getNumBytesRemaining())
+        return false;
+
+    juce::Array<int> lengths;
+    for (int i = 0; i < numPatterns; ++i)
+        lengths.add(stream.readInt());
+
+    // Empty records keep the default pattern without being decoded
+    for (int index = 0; index < numPatterns; ++index)
+    {
+        const int length = lengths[index];
+        if (length < 0 || length > stream.getNumBytesRemaining())
+            return false;
+
+        const auto *record = static_cast<const char *>(stream.getData()) + stream.getPosition();
+        stream.skipNextBytes(length);
+
+        if (length == 0 || index >= numBankPatterns)
+            continue;
+
+        juce::MemoryInputStream recordStream(record, (size_t)length, false);
+        if (!readPattern(recordStream, numSteps, state.patterns[(size_t)index]))
+            return false;
+    }
+
+    return true;
+}
+
+bool StateFormat::readPattern(juce::InputStream &stream, int numSteps, Pattern &pattern)
+{
+    const int numLanes = (uint8_t)stream.readByte();
+    for (int i = 0; i < numLanes; ++i)
+    {
+        const auto id = stream.readString();
+        const int valueSize = stream.readByte();
+        if ((valueSize != 1 && valueSize != 4) || (int64_t)numSteps * valueSize > stream.getNumBytesRemaining())
+            return false;
+
+        // Lanes this build doesn't know are skipped
+        int lane = 0;
+        while (lane < numStepLanes && id != stepLanes[lane].id)
+            ++lane;
+
+        for (int step = 0; step < numSteps; ++step)
+        {
+            const float value = valueSize == 1 ? (float)(uint8_t)stream.readByte() : stream.readFloat();
+
+            // Clamping lets NaN through, so values that aren't finite load as the default
+            if (lane < numStepLanes && step < maxPatternSteps)
+                pattern.setValue((StepLane)lane, step, std::isfinite(value) ? value : stepLanes[lane].defaultValue);
+        }
+    }
+
+    return true;
+}
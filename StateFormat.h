@@ -0,0 +1,53 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "StepPattern.h"
+#include "PatternBank.h"
+#include "Groove.h"
+
+// Everything the plugin saves, independent of how it is stored. Large (a
+// whole bank), so keep it on the heap.
+struct PluginState
+{
+    juce::ValueTree parameters; // the APVTS tree, without children
+    std::array<Pattern, numBankPatterns> patterns;
+    int selectedPattern = 0;
+    GrooveTemplate groove;
+    juce::String tuningScale, tuningMapping; // Scala source text, empty for the default
+};
+
+// Compact binary state. A header (magic and format version) is followed by
+// tagged sections, each prefixed with its byte length, so readers
+// skip sections they don't know and newer sections can be added without
+// breaking older builds:
+//
+//     PARM  the parameter tree (ValueTree::writeToStream)
+//     BANK  selected pattern, then a length index and one record per pattern
+//     GROV  groove template
+//     TUNE  Scala scale and keyboard mapping text
+//
+// Pattern records only hold the lanes that differ from their defaults.
+// Untouched patterns are empty records that are skipped; every other record
+// is decoded when the state is read. Values that aren't finite load as their
+// lane's default (or no groove offset).
+//
+// Migration is one way: sessions saved as XML by earlier versions are
+// detected and migrated on load, but no XML copy is written, so builds from
+// before this format load binary state as nothing.
+class StateFormat
+{
+public:
+    static constexpr int version = 1;
+
+    static void write(const PluginState &state, juce::MemoryBlock &destData);
+
+    // Returns false if the data isn't binary state or is damaged
+    static bool read(const void *data, int sizeInBytes, PluginState &state);
+
+    static bool isBinaryState(const void *data, int sizeInBytes);
+
+private:
+    static void writePattern(juce::OutputStream &stream, const Pattern &pattern);
+    static bool readPattern(juce::InputStream &stream, int numSteps, Pattern &pattern);
+    static bool readBank(juce::MemoryInputStream &stream, PluginState &state);
+};
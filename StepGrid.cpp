@@ -0,0 +1,171 @@
+#include "StepGrid.h"
+
+StepGrid::StepGrid(StepSequencerAudioProcessor &p)
+    : processor(p)
+{
+    for (int lane = 0; lane < numStepLanes; ++lane)
+    {
+        rows.push_back(std::make_unique<LaneRow>(*this, (StepLane)lane));
+        addAndMakeVisible(*rows.back());
+    }
+
+    reload();
+    setLength(processor.getPatternLength());
+}
+
+void StepGrid::reload()
+{
+    staged = processor.getEditPattern();
+    dirtyLanes.fill(false);
+
+    for (auto &row : rows)
+        row->repaint();
+}
+
+void StepGrid::setLength(int newLength)
+{
+    length = juce::jlimit(1, maxPatternSteps, newLength);
+    setSize(length * cellWidth, numStepLanes * rowHeight);
+}
+
+void StepGrid::setPlayhead(int step)
+{
+    if (step == playhead)
+        return;
+
+    // Only the two cells that changed in each lane are repainted
+    for (auto &row : rows)
+    {
+        row->repaintStep(playhead);
+        row->repaintStep(step);
+    }
+    playhead = step;
+}
+
+bool StepGrid::hasStagedEdits() const
+{
+    return std::any_of(dirtyLanes.begin(), dirtyLanes.end(), [](bool dirty)
+                       { return dirty; });
+}
+
+bool StepGrid::flush()
+{
+    if (!hasStagedEdits())
+        return false;
+
+    processor.modifyPattern([this](Pattern &pattern)
+                            {
+        for (int lane = 0; lane < numStepLanes; ++lane)
+            if (dirtyLanes[(size_t)lane])
+                for (int i = 0; i < maxPatternSteps; ++i)
+                    pattern.setValue((StepLane)lane, i, staged.getValue((StepLane)lane, i)); });
+
+    dirtyLanes.fill(false);
+    return true;
+}
+
+void StepGrid::resized()
+{
+    for (int lane = 0; lane < numStepLanes; ++lane)
+        rows[(size_t)lane]->setBounds(0, lane * rowHeight, getWidth(), rowHeight);
+}
+
+StepGrid::LaneRow::LaneRow(StepGrid &g, StepLane l)
+    : grid(g), lane(l)
+{
+    setOpaque(true);
+}
+
+void StepGrid::LaneRow::paint(juce::Graphics &g)
+{
+    const auto &info = getLaneInfo(lane);
+    const float height = (float)getHeight();
+    const float range = info.maxValue - info.minValue;
+
+    // Bipolar lanes (pitch, timing) grow from the middle, the rest from the bottom
+    const float zero = info.minValue < 0.0f ? height * (info.maxValue / range) : height;
+
+    // Only the cells inside the area being repainted
+    const auto clip = g.getClipBounds();
+    const int first = juce::jmax(0, clip.getX() / cellWidth);
+    const int last = juce::jmin(grid.length - 1, clip.getRight() / cellWidth);
+
+    for (int step = first; step <= last; ++step)
+    {
+        const int x = step * cellWidth;
+
+        // Shade every other beat
+        g.setColour((step / 4) % 2 == 0 ? juce::Colour(0xff2a2a2a) : juce::Colour(0xff333333));
+        if (step == grid.playhead)
+            g.setColour(juce::Colours::green.withAlpha(0.6f));
+        g.fillRect(x, 0, cellWidth, getHeight());
+
+        const float value = grid.staged.getValue(lane, step);
+        const float y = height * (1.0f - (value - info.minValue) / range);
+        g.setColour(juce::Colours::lightblue);
+        g.fillRect(juce::Rectangle<float>((float)x + 2.0f, juce::jmin(y, zero), (float)cellWidth - 4.0f,
+                                          juce::jmax(1.0f, std::abs(zero - y))));
+    }
+
+    g.setColour(juce::Colours::black);
+    g.drawHorizontalLine(getHeight() - 1, (float)clip.getX(), (float)clip.getRight());
+
+    // Lane name pinned to the left edge of the visible area
+    int visibleX = 0;
+    if (auto *viewport = findParentComponentOfClass<juce::Viewport>())
+        visibleX = viewport->getViewPositionX();
+
+    g.setColour(juce::Colours::white.withAlpha(0.7f));
+    g.setFont(12.0f);
+    g.drawText(info.name, visibleX + 4, 2, 100, 14, juce::Justification::left);
+}
+
+int StepGrid::LaneRow::getStepAt(int x) const
+{
+    return juce::jlimit(0, grid.length - 1, x / cellWidth);
+}
+
+float StepGrid::LaneRow::getValueAt(int y) const
+{
+    const auto &info = getLaneInfo(lane);
+    const float proportion = 1.0f - juce::jlimit(0.0f, 1.0f, (float)y / (float)getHeight());
+    return info.minValue + proportion * (info.maxValue - info.minValue);
+}
+
+void StepGrid::LaneRow::setStep(int step, float value)
+{
+    grid.staged.setValue(lane, step, value);
+    grid.dirtyLanes[(size_t)lane] = true;
+    repaintStep(step);
+}
+
+void StepGrid::LaneRow::mouseDown(const juce::MouseEvent &event)
+{
+    lastStep = getStepAt(event.x);
+    lastValue = getValueAt(event.y);
+    setStep(lastStep, lastValue);
+}
+
+void StepGrid::LaneRow::mouseDrag(const juce::MouseEvent &event)
+{
+    const int step = getStepAt(event.x);
+    const float value = getValueAt(event.y);
+
+    // Fill the steps skipped by a fast drag with a straight line
+    const int distance = std::abs(step - lastStep);
+    for (int i = 1; i <= distance; ++i)
+    {
+        const float t = (float)i / (float)distance;
+        setStep(lastStep + (step > lastStep ? i : -i), lastValue + (value - lastValue) * t);
+    }
+    if (distance == 0)
+        setStep(step, value);
+
+    lastStep = step;
+    lastValue = value;
+}
+
+void StepGrid::LaneRow::mouseDoubleClick(const juce::MouseEvent &event)
+{
+    setStep(getStepAt(event.x), getLaneInfo(lane).defaultValue);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+// Grid editor for every lane of the selected pattern, meant to sit in a
+// juce::Viewport. Each lane is a single component that paints only the cells
+// inside its clip region and maps mouse positions to steps arithmetically.
+// Edits land in a staged copy of the pattern and are published together by
+// flush(), once per UI frame, however many cells a drag touched.
+class StepGrid : public juce::Component
+{
+public:
+    static constexpr int cellWidth = 24;
+    static constexpr int rowHeight = 30;
+
+    explicit StepGrid(StepSequencerAudioProcessor &processor);
+
+    // Re-reads the selected pattern (after edits made elsewhere), dropping
+    // staged edits. Callers editing the same pattern flush() first.
+    void reload();
+
+    void setLength(int newLength);
+    void setPlayhead(int step);
+
+    // Publishes staged edits as one pattern snapshot. Returns true if anything changed.
+    bool flush();
+    bool hasStagedEdits() const;
+
+    void resized() override;
+
+private:
+    class LaneRow : public juce::Component
+    {
+    public:
+        LaneRow(StepGrid &grid, StepLane lane);
+
+        void paint(juce::Graphics &g) override;
+        void mouseDown(const juce::MouseEvent &event) override;
+        void mouseDrag(const juce::MouseEvent &event) override;
+        void mouseDoubleClick(const juce::MouseEvent &event) override;
+
+        void repaintStep(int step) { repaint(step * cellWidth, 0, cellWidth, getHeight()); }
+
+    private:
+        int getStepAt(int x) const;
+        float getValueAt(int y) const;
+        void setStep(int step, float value);
+
+        StepGrid &grid;
+        const StepLane lane;
+        int lastStep = -1;
+        float lastValue = 0.0f;
+    };
+
+    StepSequencerAudioProcessor &processor;
+    Pattern staged;
+    std::array<bool, numStepLanes> dirtyLanes{};
+    int length = defaultPatternLength;
+    int playhead = -1;
+    std::vector<std::unique_ptr<LaneRow>> rows;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StepGrid)
+};
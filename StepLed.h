@@ -0,0 +1,65 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// A step indicator. Being its own component, a state change repaints just
+// its own bounds instead of the whole editor.
+class StepLed : public juce::Component
+{
+public:
+    enum class State
+    {
+        idle,
+        inactive, // past the end of the pattern
+        passed,   // played since the previous frame
+        current,  // the playhead is here, gate closed
+        gate      // the playhead is here and its gate is open
+    };
+
+    StepLed()
+    {
+        setInterceptsMouseClicks(false, false);
+    }
+
+    void setState(State newState)
+    {
+        if (newState == state)
+            return;
+
+        state = newState;
+        repaint();
+    }
+
+    void paint(juce::Graphics &g) override
+    {
+        const auto bounds = getLocalBounds().toFloat().reduced(0.5f);
+
+        g.setColour(getColour());
+        g.fillRoundedRectangle(bounds, 4.0f);
+
+        // Border
+        g.setColour(juce::Colours::grey);
+        g.drawRoundedRectangle(bounds, 4.0f, 1.0f);
+    }
+
+private:
+    juce::Colour getColour() const
+    {
+        switch (state)
+        {
+        case State::gate:
+            return juce::Colours::lime;
+        case State::current:
+            return juce::Colours::green;
+        case State::passed:
+            return juce::Colours::lime.withAlpha(0.5f);
+        case State::inactive:
+            return juce::Colours::darkgrey.darker();
+        case State::idle:
+            break;
+        }
+        return juce::Colours::darkgrey;
+    }
+
+    State state = State::idle;
+};
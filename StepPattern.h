@@ -0,0 +1,177 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TrigCondition.h"
+
+static constexpr int maxPatternSteps = 128;
+static constexpr int defaultPatternLength = 8;
+
+static constexpr float minStepPitch = -12.0f;
+static constexpr float maxStepPitch = 12.0f;
+static constexpr int maxRatchets = 8;
+static constexpr float maxTimingOffset = 0.5f; // fraction of a step, early or late
+
+// Per-step data lanes
+enum class StepLane
+{
+    pitch,
+    velocity,
+    gate,
+    probability,
+    ratchet,
+    slide,
+    timing,
+    cc,
+    condition
+};
+
+struct StepLaneInfo
+{
+    const char *id;   // used in saved state
+    const char *name; // shown in the editor
+    float minValue;
+    float maxValue;
+    float interval;
+    float defaultValue;
+};
+
+// Indexed by StepLane
+static constexpr StepLaneInfo stepLanes[] = {
+    {"pitch", "Pitch", minStepPitch, maxStepPitch, 0.01f, 0.0f},
+    {"velocity", "Velocity", 0.0f, 1.0f, 0.01f, 1.0f},
+    {"gate", "Gate", 0.01f, 1.0f, 0.01f, 1.0f},
+    {"probability", "Probability", 0.0f, 1.0f, 0.01f, 1.0f},
+    {"ratchet", "Ratchet", 1.0f, (float)maxRatchets, 1.0f, 1.0f},
+    {"slide", "Slide", 0.0f, 1.0f, 1.0f, 0.0f},
+    {"timing", "Timing", -maxTimingOffset, maxTimingOffset, 0.01f, 0.0f},
+    {"cc", "MIDI CC", 0.0f, 127.0f, 1.0f, 64.0f},
+    {"condition", "Condition", 0.0f, (float)(numTrigConditions - 1), 1.0f, 0.0f}};
+
+static constexpr int numStepLanes = (int)std::size(stepLanes);
+
+inline const StepLaneInfo &getLaneInfo(StepLane lane) { return stepLanes[(int)lane]; }
+
+// Fixed-capacity step storage owned by the engine. Each lane is its own
+// contiguous array (structure-of-arrays), so step playback only touches the
+// lanes it reads and a lane can be copied as one block. The whole pattern is
+// cache-line aligned; how many steps play is set by the "length" parameter.
+template <int MaxSteps>
+struct alignas(64) StepPattern
+{
+    static_assert(MaxSteps > 0, "A pattern needs at least one step");
+    static constexpr int capacity = MaxSteps;
+    static constexpr size_t laneSize = (size_t)MaxSteps;
+
+    float pitch[laneSize];       // semitones (±12)
+    float velocity[laneSize];    // 0..1, scales the output level
+    float gate[laneSize];        // fraction of the gate parameter
+    float probability[laneSize]; // chance the step triggers
+    uint8_t ratchet[laneSize];   // retriggers within the step (1..8)
+    uint8_t slide[laneSize];     // glide into this step even with glide off
+    float timing[laneSize];      // micro-timing offset, fraction of a step
+    uint8_t cc[laneSize];        // controller value sent with the step in MIDI output mode
+    uint8_t condition[laneSize]; // index into trigConditions
+
+    StepPattern() { clear(); }
+
+    void clear()
+    {
+        std::fill(std::begin(pitch), std::end(pitch), getLaneInfo(StepLane::pitch).defaultValue);
+        std::fill(std::begin(velocity), std::end(velocity), getLaneInfo(StepLane::velocity).defaultValue);
+        std::fill(std::begin(gate), std::end(gate), getLaneInfo(StepLane::gate).defaultValue);
+        std::fill(std::begin(probability), std::end(probability), getLaneInfo(StepLane::probability).defaultValue);
+        std::fill(std::begin(ratchet), std::end(ratchet), (uint8_t)1);
+        std::fill(std::begin(slide), std::end(slide), (uint8_t)0);
+        std::fill(std::begin(timing), std::end(timing), getLaneInfo(StepLane::timing).defaultValue);
+        std::fill(std::begin(cc), std::end(cc), (uint8_t)getLaneInfo(StepLane::cc).defaultValue);
+        std::fill(std::begin(condition), std::end(condition), (uint8_t)0);
+    }
+
+    float getValue(StepLane lane, int step) const
+    {
+        switch (lane)
+        {
+        case StepLane::pitch:
+            return pitch[step];
+        case StepLane::velocity:
+            return velocity[step];
+        case StepLane::gate:
+            return gate[step];
+        case StepLane::probability:
+            return probability[step];
+        case StepLane::ratchet:
+            return (float)ratchet[step];
+        case StepLane::slide:
+            return (float)slide[step];
+        case StepLane::timing:
+            return timing[step];
+        case StepLane::cc:
+            return (float)cc[step];
+        case StepLane::condition:
+            return (float)condition[step];
+        }
+        return 0.0f;
+    }
+
+    // Clamps (and for the integer lanes, rounds) the value into the lane's range
+    void setValue(StepLane lane, int step, float value)
+    {
+        const auto &info = getLaneInfo(lane);
+        value = juce::jlimit(info.minValue, info.maxValue, value);
+
+        switch (lane)
+        {
+        case StepLane::pitch:
+            pitch[step] = value;
+            break;
+        case StepLane::velocity:
+            velocity[step] = value;
+            break;
+        case StepLane::gate:
+            gate[step] = value;
+            break;
+        case StepLane::probability:
+            probability[step] = value;
+            break;
+        case StepLane::ratchet:
+            ratchet[step] = (uint8_t)juce::roundToInt(value);
+            break;
+        case StepLane::slide:
+            slide[step] = value >= 0.5f ? 1 : 0;
+            break;
+        case StepLane::timing:
+            timing[step] = value;
+            break;
+        case StepLane::cc:
+            cc[step] = (uint8_t)juce::roundToInt(value);
+            break;
+        case StepLane::condition:
+            condition[step] = (uint8_t)juce::roundToInt(value);
+            break;
+        }
+    }
+
+    // Rotates every lane of the first 'length' steps by 'offset' (positive moves steps later)
+    void rotate(int offset, int length)
+    {
+        jassert(length > 0 && length <= MaxSteps);
+        int first = ((-offset % length) + length) % length;
+
+        auto rotateLane = [first, length](auto *lane)
+        { std::rotate(lane, lane + first, lane + length); };
+
+        rotateLane(pitch);
+        rotateLane(velocity);
+        rotateLane(gate);
+        rotateLane(probability);
+        rotateLane(ratchet);
+        rotateLane(slide);
+        rotateLane(timing);
+        rotateLane(cc);
+        rotateLane(condition);
+    }
+};
+
+using Pattern = StepPattern<maxPatternSteps>;
+
+static_assert(std::is_trivially_copyable_v<Pattern>, "Patterns are copied as plain memory");
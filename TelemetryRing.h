@@ -0,0 +1,61 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// What the audio thread reports to the editor, stamped with the sample clock
+struct TelemetryEvent
+{
+    enum class Type : uint8_t
+    {
+        clock,   // start of a block: maps the sample clock to wall time
+        step,    // the playhead reached 'step'
+        gateOn,  // a note started ('note', 'velocity')
+        gateOff, // the sounding note ended
+        stop     // the last held key was released
+    };
+
+    Type type = Type::clock;
+    int64_t time = 0; // sample clock
+    int step = 0;
+    int note = 0;
+    float velocity = 0.0f;
+    double milliseconds = 0.0; // clock events: Time::getMillisecondCounterHiRes() at 'time'
+    double sampleRate = 0.0;   // clock events
+};
+
+// Wait-free single-producer/single-consumer ring from the audio thread to the
+// editor. Events are dropped, never blocked on, when nobody drains the ring
+// (e.g. while the editor is closed).
+class TelemetryRing
+{
+public:
+    static constexpr int capacity = 2048;
+
+    // Audio thread
+    bool push(const TelemetryEvent &event)
+    {
+        const auto scope = fifo.write(1);
+        if (scope.blockSize1 == 0)
+            return false;
+
+        events[(size_t)scope.startIndex1] = event;
+        return true;
+    }
+
+    // Message thread
+    bool hasPending() const { return fifo.getNumReady() > 0; }
+
+    bool pop(TelemetryEvent &event)
+    {
+        const auto scope = fifo.read(1);
+        if (scope.blockSize1 == 0)
+            return false;
+
+        event = events[(size_t)scope.startIndex1];
+        return true;
+    }
+
+private:
+    juce::AbstractFifo fifo{capacity};
+    std::array<TelemetryEvent, capacity> events;
+};
@@ -0,0 +1,170 @@
+#include "Tracing.h"
+
+#if STEP_SEQUENCER_TRACING
+
+// One recording thread's ring. The owning thread is the only producer and
+// the TraceWriter thread the only consumer.
+struct ThreadTrace
+{
+    static constexpr int capacity = 8192;
+
+    juce::AbstractFifo fifo{capacity};
+    std::array<TraceEvent, capacity> events;
+    juce::Thread::ThreadID threadId = nullptr;
+    std::atomic<bool> ready{false}; // set once the id is filled in
+};
+
+struct TracePool
+{
+    std::array<ThreadTrace, maxTracedThreads> threads;
+    std::atomic<int> numClaimed{0};
+    const int64_t origin = juce::Time::getHighResolutionTicks();
+};
+
+static TracePool &getTracePool()
+{
+    static TracePool pool;
+    return pool;
+}
+
+// Claims a ring the first time a thread records; nullptr once the pool is
+// used up. Only the thread id is kept here; TraceWriter names the thread.
+static ThreadTrace *getThreadTrace()
+{
+    thread_local ThreadTrace *trace = nullptr;
+    thread_local bool claimed = false;
+
+    if (!claimed)
+    {
+        claimed = true;
+        auto &pool = getTracePool();
+        const int index = pool.numClaimed.fetch_add(1);
+        if (index < maxTracedThreads)
+        {
+            trace = &pool.threads[(size_t)index];
+            trace->threadId = juce::Thread::getCurrentThreadId();
+            trace->ready.store(true, std::memory_order_release);
+        }
+    }
+
+    return trace;
+}
+
+// The message thread by name; other threads by their slot and the first span
+// they recorded, e.g. "Thread 2 (processBlock)"
+static juce::String getTraceThreadName(const ThreadTrace &trace, int index, const char *firstSpan)
+{
+    if (auto *messageManager = juce::MessageManager::getInstanceWithoutCreating())
+        if (messageManager->getCurrentMessageThread() == trace.threadId)
+            return "Message thread";
+
+    return "Thread " + juce::String(index) + " (" + firstSpan + ")";
+}
+
+void TraceSpan::end()
+{
+    if (ended)
+        return;
+    ended = true;
+
+    // Spans are dropped, never waited on, when the writer falls behind
+    if (auto *trace = getThreadTrace())
+    {
+        const auto scope = trace->fifo.write(1);
+        if (scope.blockSize1 > 0)
+            trace->events[(size_t)scope.startIndex1] = {name, start, juce::Time::getHighResolutionTicks()};
+    }
+}
+
+TraceWriter::TraceWriter() : juce::Thread("Trace Writer")
+{
+    const auto file = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                          .getChildFile("StepSequencerTrace-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S") + ".json");
+
+    stream = std::make_unique<juce::FileOutputStream>(file);
+    if (stream->failedToOpen())
+    {
+        stream.reset();
+        return;
+    }
+
+    DBG("Tracing to " << file.getFullPathName());
+    stream->setPosition(0);
+    stream->truncate();
+    stream->writeText("[\n", false, false, nullptr);
+    startThread(juce::Thread::Priority::low);
+}
+
+TraceWriter::~TraceWriter()
+{
+    stopThread(1000);
+
+    if (stream != nullptr)
+    {
+        drain();
+        stream->writeText("\n]\n", false, false, nullptr);
+    }
+}
+
+void TraceWriter::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(100);
+        drain();
+    }
+}
+
+void TraceWriter::drain()
+{
+    auto &pool = getTracePool();
+    const double microsecondsPerTick = 1.0e6 / (double)juce::Time::getHighResolutionTicksPerSecond();
+    const int numThreads = juce::jmin(maxTracedThreads, pool.numClaimed.load());
+
+    juce::String text;
+    auto separator = [this]
+    { return numWritten++ == 0 ? "" : ",\n"; };
+
+    for (int tid = 0; tid < numThreads; ++tid)
+    {
+        auto &trace = pool.threads[(size_t)tid];
+        if (!trace.ready.load(std::memory_order_acquire))
+            continue;
+
+        const auto scope = trace.fifo.read(trace.fifo.getNumReady());
+        if (scope.blockSize1 + scope.blockSize2 == 0)
+            continue;
+
+        const char *firstSpan = trace.events[(size_t)scope.startIndex1].name;
+        auto append = [&](int start, int count)
+        {
+            for (int i = start; i < start + count; ++i)
+            {
+                const auto &event = trace.events[(size_t)i];
+                text << separator()
+                     << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                     << ",\"ts\":" << juce::String((double)(event.start - pool.origin) * microsecondsPerTick, 3)
+                     << ",\"dur\":" << juce::String((double)(event.end - event.start) * microsecondsPerTick, 3) << "}";
+            }
+        };
+        append(scope.startIndex1, scope.blockSize1);
+        append(scope.startIndex2, scope.blockSize2);
+
+        // Name the thread once, with its first batch
+        if (!namedThreads[(size_t)tid])
+        {
+            namedThreads[(size_t)tid] = true;
+            text << separator()
+                 << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+                 << ",\"args\":{\"name\":" << juce::JSON::toString(getTraceThreadName(trace, tid, firstSpan)) << "}}";
+        }
+    }
+
+    if (text.isNotEmpty())
+    {
+        stream->writeText(text, false, false, nullptr);
+        stream->flush();
+    }
+}
+
+#endif
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Optional span tracing for diagnosing dropouts, enabled with the
+// STEP_SEQUENCER_TRACING CMake option. Each thread records into its own
+// wait-free ring; a TraceWriter thread drains the rings into a Chrome
+// trace-event JSON file (opens in chrome://tracing and ui.perfetto.dev).
+//
+//     TRACE_SCOPE("processBlock");          // until the end of the scope
+//     TRACE_BEGIN(midi, "midi"); ... TRACE_END(midi);
+//
+// Without the option every macro expands to nothing.
+#if STEP_SEQUENCER_TRACING
+
+// Threads beyond this many record nothing
+static constexpr int maxTracedThreads = 32;
+
+// A finished span. 'name' must be a string literal.
+struct TraceEvent
+{
+    const char *name = nullptr;
+    int64_t start = 0; // high-resolution ticks
+    int64_t end = 0;
+};
+
+// Records spans for the calling thread. The first span a thread records
+// claims one of a fixed pool of rings and notes the thread id, so recording
+// never allocates or locks; thread names are resolved when the file is written.
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *spanName) : name(spanName), start(juce::Time::getHighResolutionTicks()) {}
+    ~TraceSpan() { end(); }
+
+    void end();
+
+private:
+    const char *name;
+    int64_t start;
+    bool ended = false;
+
+    JUCE_DECLARE_NON_COPYABLE(TraceSpan)
+};
+
+// Drains every thread's ring into a trace file in the temp directory while
+// at least one instance holds it. Use through juce::SharedResourcePointer.
+class TraceWriter : private juce::Thread
+{
+public:
+    TraceWriter();
+    ~TraceWriter() override;
+
+private:
+    void run() override;
+    void drain();
+
+    std::unique_ptr<juce::FileOutputStream> stream;
+    int numWritten = 0;
+    std::array<bool, maxTracedThreads> namedThreads{};
+
+    JUCE_DECLARE_NON_COPYABLE(TraceWriter)
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)
+#define TRACE_BEGIN(id, name) TraceSpan traceSpan_##id(name)
+#define TRACE_END(id) traceSpan_##id.end()
+
+#else
+
+#define TRACE_SCOPE(name)
+#define TRACE_BEGIN(id, name)
+#define TRACE_END(id)
+
+#endif
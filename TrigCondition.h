@@ -0,0 +1,73 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Conditional trigs: a step with a condition other than "Always" only plays
+// when the condition holds. Conditions are evaluated once per step, when the
+// step is scheduled.
+enum class TrigConditionType : uint8_t
+{
+    always,
+    ratio,      // plays on loop A of every B loops of the pattern
+    fill,       // plays only while the "fill" parameter is on
+    notFill,    // plays only while it is off
+    previous,   // plays if the last conditional step played
+    notPrevious // plays if it didn't
+};
+
+struct TrigConditionInfo
+{
+    const char *name;
+    TrigConditionType type;
+    int a;
+    int b;
+};
+
+// Indexed by the value stored in a step's condition lane
+static constexpr TrigConditionInfo trigConditions[] = {
+    {"Always", TrigConditionType::always, 0, 0},
+    {"1:2", TrigConditionType::ratio, 1, 2},
+    {"2:2", TrigConditionType::ratio, 2, 2},
+    {"1:3", TrigConditionType::ratio, 1, 3},
+    {"2:3", TrigConditionType::ratio, 2, 3},
+    {"3:3", TrigConditionType::ratio, 3, 3},
+    {"1:4", TrigConditionType::ratio, 1, 4},
+    {"2:4", TrigConditionType::ratio, 2, 4},
+    {"3:4", TrigConditionType::ratio, 3, 4},
+    {"4:4", TrigConditionType::ratio, 4, 4},
+    {"Fill", TrigConditionType::fill, 0, 0},
+    {"Not Fill", TrigConditionType::notFill, 0, 0},
+    {"Previous", TrigConditionType::previous, 0, 0},
+    {"Not Previous", TrigConditionType::notPrevious, 0, 0}};
+
+static constexpr int numTrigConditions = (int)std::size(trigConditions);
+
+// Previous/Not Previous steps read the last result but don't replace it
+inline bool isPreviousCondition(int condition)
+{
+    const auto type = trigConditions[juce::jlimit(0, numTrigConditions - 1, condition)].type;
+    return type == TrigConditionType::previous || type == TrigConditionType::notPrevious;
+}
+
+// 'loop' counts pattern loops since the sequencer was (re)started
+inline bool isTrigConditionMet(int condition, int64_t loop, bool fill, bool previous)
+{
+    const auto &info = trigConditions[juce::jlimit(0, numTrigConditions - 1, condition)];
+
+    switch (info.type)
+    {
+    case TrigConditionType::always:
+        return true;
+    case TrigConditionType::ratio:
+        return loop % info.b == info.a - 1;
+    case TrigConditionType::fill:
+        return fill;
+    case TrigConditionType::notFill:
+        return !fill;
+    case TrigConditionType::previous:
+        return previous;
+    case TrigConditionType::notPrevious:
+        return !previous;
+    }
+    return true;
+}
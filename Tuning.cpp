@@ -0,0 +1,155 @@
+#include "Tuning.h"
+
+// Non-comment lines of a Scala file, trimmed
+static juce::StringArray getScalaLines(const juce::String &text)
+{
+    juce::StringArray lines;
+    for (auto line : juce::StringArray::fromLines(text))
+        if (!line.startsWithChar('!'))
+            lines.add(line.trim());
+    return lines;
+}
+
+bool ScalaScale::parse(const juce::String &text)
+{
+    const auto lines = getScalaLines(text);
+    if (lines.size() < 2)
+        return false;
+
+    const int count = lines[1].getIntValue();
+    if (count <= 0 || lines.size() < count + 2)
+        return false;
+
+    juce::Array<double> parsed;
+    for (int i = 0; i < count; ++i)
+    {
+        // Cents contain a period; anything else is a ratio "n/d" or a whole number
+        const auto token = lines[i + 2].upToFirstOccurrenceOf(" ", false, false);
+        double value;
+        if (token.containsChar('.'))
+        {
+            value = token.getDoubleValue();
+        }
+        else
+        {
+            const double numerator = token.upToFirstOccurrenceOf("/", false, false).getDoubleValue();
+            const double denominator = token.containsChar('/') ? token.fromFirstOccurrenceOf("/", false, false).getDoubleValue() : 1.0;
+            if (numerator <= 0.0 || denominator <= 0.0)
+                return false;
+            value = 1200.0 * std::log2(numerator / denominator);
+        }
+        parsed.add(value);
+    }
+
+    // A zero or negative period would map every octave onto the same pitch
+    if (parsed.getLast() <= 0.0)
+        return false;
+
+    description = lines[0];
+    cents = parsed;
+    return true;
+}
+
+ScalaScale ScalaScale::twelveTone()
+{
+    ScalaScale scale;
+    scale.description = "12-TET";
+    for (int i = 1; i <= 12; ++i)
+        scale.cents.add(100.0 * i);
+    return scale;
+}
+
+bool KeyboardMapping::parse(const juce::String &text)
+{
+    const auto lines = getScalaLines(text);
+    if (lines.size() < 7)
+        return false;
+
+    KeyboardMapping parsed;
+    parsed.size = lines[0].getIntValue();
+    parsed.firstNote = juce::jlimit(0, 127, lines[1].getIntValue());
+    parsed.lastNote = juce::jlimit(0, 127, lines[2].getIntValue());
+    parsed.middleNote = juce::jlimit(0, 127, lines[3].getIntValue());
+    parsed.referenceNote = juce::jlimit(0, 127, lines[4].getIntValue());
+    parsed.referenceFrequency = lines[5].getDoubleValue();
+    parsed.octaveDegree = lines[6].getIntValue();
+
+    // Mapping entries past the MIDI range are never played, so larger sizes
+    // are refused; this also bounds what a corrupt size line can allocate
+    if (parsed.size < 0 || parsed.size > numTuningNotes || parsed.referenceFrequency <= 0.0 || parsed.octaveDegree < 0)
+        return false;
+
+    // Missing trailing entries are unmapped
+    for (int i = 0; i < parsed.size; ++i)
+    {
+        const auto entry = lines[i + 7];
+        parsed.mapping.add(entry.isEmpty() || entry.startsWithIgnoreCase("x") ? -1 : entry.getIntValue());
+    }
+
+    *this = parsed;
+    return true;
+}
+
+TuningTable::TuningTable()
+{
+    for (int note = 0; note < numTuningNotes; ++note)
+        frequencies[note] = 440.0f * std::pow(2.0f, ((float)note - 69.0f) / 12.0f);
+}
+
+// Cents of an absolute scale degree (degree 0 is the tonic, degree N the period)
+static double getDegreeCents(const ScalaScale &scale, int degree)
+{
+    const int size = scale.cents.size();
+    const int period = (int)std::floor((double)degree / size);
+    const int index = degree - period * size;
+    return period * scale.cents.getLast() + (index == 0 ? 0.0 : scale.cents[index - 1]);
+}
+
+// Scale degree played by a key, or false if the key is unmapped
+static bool getKeyDegree(const ScalaScale &scale, const KeyboardMapping &mapping, int note, int &degree)
+{
+    if (mapping.size == 0)
+    {
+        degree = note - mapping.middleNote;
+        return true;
+    }
+
+    const int octaveDegree = mapping.octaveDegree > 0 ? mapping.octaveDegree : scale.cents.size();
+    const int offset = note - mapping.middleNote;
+    const int octave = (int)std::floor((double)offset / mapping.size);
+    const int index = offset - octave * mapping.size;
+
+    const int mapped = mapping.mapping[index];
+    if (mapped < 0)
+        return false;
+
+    degree = mapped + octave * octaveDegree;
+    return true;
+}
+
+TuningTable TuningTable::build(const ScalaScale &scale, const KeyboardMapping &mapping)
+{
+    TuningTable table;
+
+    int referenceDegree;
+    if (scale.cents.isEmpty() || !getKeyDegree(scale, mapping, mapping.referenceNote, referenceDegree))
+        return table;
+
+    const double referenceCents = getDegreeCents(scale, referenceDegree);
+
+    for (int note = 0; note < numTuningNotes; ++note)
+    {
+        int degree;
+        if (note < mapping.firstNote || note > mapping.lastNote || !getKeyDegree(scale, mapping, note, degree))
+        {
+            // Unmapped keys repeat the key below
+            table.frequencies[note] = note > 0 ? table.frequencies[note - 1] : (float)mapping.referenceFrequency;
+            continue;
+        }
+
+        const double cents = getDegreeCents(scale, degree) - referenceCents;
+        table.frequencies[note] = (float)(mapping.referenceFrequency * std::pow(2.0, cents / 1200.0));
+    }
+
+    return table;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+static constexpr int numTuningNotes = 128;
+
+// A Scala scale (.scl): pitches in cents above the tonic, the last one being
+// the period (usually the octave)
+struct ScalaScale
+{
+    juce::String description;
+    juce::Array<double> cents;
+
+    // Returns false (and leaves the scale untouched) if the text isn't a valid scale
+    bool parse(const juce::String &text);
+
+    static ScalaScale twelveTone();
+};
+
+// A Scala keyboard mapping (.kbm): which scale degree each key plays and
+// which key is tuned to the reference frequency
+struct KeyboardMapping
+{
+    int size = 0; // 0 = every key plays the next degree, at most numTuningNotes
+    int firstNote = 0;
+    int lastNote = 127;
+    int middleNote = 60; // key playing the scale's tonic
+    int referenceNote = 69;
+    double referenceFrequency = 440.0;
+    int octaveDegree = 0; // 0 = the scale's period
+    juce::Array<int> mapping; // -1 for unmapped keys
+
+    bool parse(const juce::String &text);
+};
+
+// Frequency of every MIDI note. Built off the audio thread and swapped in as
+// a snapshot, so the audio thread only ever reads a complete table.
+struct TuningTable
+{
+    float frequencies[numTuningNotes];
+
+    TuningTable(); // 12-TET, A4 = 440 Hz
+
+    static TuningTable build(const ScalaScale &scale, const KeyboardMapping &mapping);
+
+    // Fractional notes interpolate between neighbouring entries
+    float getFrequency(float note) const
+    {
+        note = juce::jlimit(0.0f, (float)(numTuningNotes - 1), note);
+        const int index = juce::jmin((int)note, numTuningNotes - 2);
+        const float fraction = note - (float)index;
+        return frequencies[index] + (frequencies[index + 1] - frequencies[index]) * fraction;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<TuningTable>, "Tuning tables are copied as plain memory");